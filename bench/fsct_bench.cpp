@@ -0,0 +1,389 @@
+// Benchmark suite for the cipher, dictionary and analysis hot paths. Every
+// case runs at several input sizes and reports latency and throughput; the
+// results can be saved as JSON Lines and compared against a saved baseline.
+//
+//   fsct_bench [--sizes=1K,16K,256K] [--filter=text] [--min-time=seconds]
+//              [--json=file] [--baseline=file] [--threshold=percent]
+#include "../include/analysis/entropy_calculator.hpp"
+#include "../include/analysis/frequency_analyzer.hpp"
+#include "../include/analysis/language_matcher.hpp"
+#include "../include/analysis/pattern_finder.hpp"
+#include "../include/ciphers/affine.hpp"
+#include "../include/ciphers/caesar.hpp"
+#include "../include/ciphers/playfair.hpp"
+#include "../include/ciphers/transposition.hpp"
+#include "../include/ciphers/vigenere.hpp"
+#include "../include/dictionary/dictionary.hpp"
+#include "../include/engine/jsonl.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+volatile uint64_t sink;
+
+// Every case runs at least MIN_RUNS times and then until --min-time is spent
+const size_t MIN_RUNS = 3;
+const size_t MAX_RUNS = 100000;
+
+const char* const WORDS[] = {
+    "the", "of", "and", "to", "in", "is", "that", "it", "was", "for", "on", "are", "with", "as", "his",
+    "they", "at", "be", "this", "from", "have", "or", "by", "one", "had", "not", "but", "what", "all",
+    "were", "when", "we", "there", "can", "an", "your", "which", "their", "said", "if", "do", "will",
+    "each", "about", "how", "up", "out", "them", "then", "she", "many", "some", "so", "these", "would",
+    "other", "into", "has", "more", "her", "two", "like", "him", "see", "time", "could", "no", "make",
+    "than", "first", "been", "its", "who", "now", "people", "my", "made", "over", "did", "down", "only",
+    "way", "find", "use", "may", "water", "long", "little", "very", "after", "words", "called", "just",
+    "where", "most", "know", "attack", "dawn", "secret", "message", "meeting", "river", "bridge", "north",
+    "south", "quick", "brown", "fox", "jumps", "lazy", "dog", "signal", "cipher", "letter", "garden",
+};
+const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+// English-like prose of exactly `length` bytes, the same for every run
+std::string makeText(size_t length) {
+    std::mt19937_64 rng(42);
+    std::string text;
+    text.reserve(length + 16);
+    size_t sentence = 0;
+    while (text.size() < length) {
+        std::string word = WORDS[rng() % WORD_COUNT];
+        if (sentence++ % 12 == 0) word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        text += word;
+        text += (sentence % 12 == 0) ? ". " : " ";
+    }
+    text.resize(length);
+    return text;
+}
+
+// Newline-separated word list of about `length` bytes for Dictionary loading
+std::string makeWordFile(size_t length) {
+    std::mt19937_64 rng(7);
+    std::string words;
+    while (words.size() < length) {
+        std::string word = WORDS[rng() % WORD_COUNT];
+        word += static_cast<char>('a' + rng() % 26);
+        word += static_cast<char>('a' + rng() % 26);
+        words += word + "\n";
+    }
+    return words;
+}
+
+size_t parseSize(const std::string& text) {
+    size_t pos = 0;
+    double value = std::stod(text, &pos);
+    std::string unit = text.substr(pos);
+    if (!unit.empty() && (unit.back() == 'B' || unit.back() == 'b')) unit.pop_back();
+    double scale = 1;
+    if (unit == "K" || unit == "k") scale = 1024;
+    else if (unit == "M" || unit == "m") scale = 1024 * 1024;
+    else if (!unit.empty()) throw std::invalid_argument("Bad size: " + text);
+    if (value <= 0) throw std::invalid_argument("Bad size: " + text);
+    return static_cast<size_t>(value * scale);
+}
+
+std::string sizeLabel(size_t bytes) {
+    if (bytes % (1024 * 1024) == 0) return std::to_string(bytes >> 20) + "M";
+    if (bytes % 1024 == 0) return std::to_string(bytes >> 10) + "K";
+    return std::to_string(bytes);
+}
+
+// suggestDecryptions reports to stdout; while a case runs its output goes
+// to /dev/null so the cost of formatting it is still measured
+class SilencedStdout {
+public:
+    SilencedStdout() {
+        std::cout.flush();
+        std::fflush(stdout);
+        saved = dup(STDOUT_FILENO);
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0) {
+            dup2(devNull, STDOUT_FILENO);
+            close(devNull);
+        }
+    }
+    ~SilencedStdout() {
+        std::cout.flush();
+        std::fflush(stdout);
+        if (saved >= 0) {
+            dup2(saved, STDOUT_FILENO);
+            close(saved);
+        }
+    }
+
+private:
+    int saved;
+};
+
+struct Case {
+    std::string name;
+    // Runs the operation once on an input of the given size
+    std::function<uint64_t(const std::string& text)> run;
+    size_t maxBytes;  // larger sizes are skipped for the slow searches
+    bool quiet;       // prints, so stdout is silenced
+};
+
+struct Result {
+    std::string name;
+    size_t bytes = 0;
+    size_t runs = 0;
+    double minNs = 0;
+    double medianNs = 0;
+    double meanNs = 0;
+    double mbPerSecond = 0;
+};
+
+Result measure(const Case& benchCase, const std::string& input, double minSeconds) {
+    std::vector<double> samples;
+    double total = 0;
+    {
+        std::unique_ptr<SilencedStdout> silence(benchCase.quiet ? new SilencedStdout() : nullptr);
+        sink = benchCase.run(input);  // warm-up
+        while (samples.size() < MIN_RUNS || (total < minSeconds * 1e9 && samples.size() < MAX_RUNS)) {
+            auto start = std::chrono::steady_clock::now();
+            sink = benchCase.run(input);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            samples.push_back(elapsed.count());
+            total += elapsed.count();
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    Result result;
+    result.name = benchCase.name;
+    result.bytes = input.size();
+    result.runs = samples.size();
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    result.meanNs = total / samples.size();
+    result.mbPerSecond = input.size() / (result.medianNs / 1e9) / 1e6;
+    return result;
+}
+
+std::vector<Case> buildCases(Dictionary* dictionary, const LanguageMatcher* matcher) {
+    const size_t unlimited = SIZE_MAX;
+    const size_t searchLimit = 16 * 1024;
+    std::vector<Case> cases;
+
+    cases.push_back({"caesar.encrypt", [=](const std::string& t) {
+        return Caesar(t, dictionary).encrypt(3).size(); }, unlimited, false});
+    cases.push_back({"caesar.decrypt", [=](const std::string& t) {
+        return Caesar(t, dictionary).decrypt(3).size(); }, unlimited, false});
+    cases.push_back({"vigenere.encrypt", [=](const std::string& t) {
+        return Vigenere(t, dictionary, "lemon").encrypt().size(); }, unlimited, false});
+    cases.push_back({"vigenere.decrypt", [=](const std::string& t) {
+        return Vigenere(t, dictionary, "lemon").decrypt().size(); }, unlimited, false});
+    cases.push_back({"affine.encrypt", [=](const std::string& t) {
+        return Affine(t, dictionary, 5, 8).encrypt().size(); }, unlimited, false});
+    cases.push_back({"affine.decrypt", [=](const std::string& t) {
+        return Affine(t, dictionary, 5, 8).decrypt().size(); }, unlimited, false});
+    cases.push_back({"transposition.encrypt", [=](const std::string& t) {
+        return Transposition(t, dictionary).encrypt(7).size(); }, unlimited, false});
+    cases.push_back({"transposition.decrypt", [=](const std::string& t) {
+        return Transposition(t, dictionary).decrypt(7).size(); }, unlimited, false});
+    cases.push_back({"playfair.encrypt", [=](const std::string& t) {
+        return Playfair(t, dictionary, "monarchy").encrypt().size(); }, unlimited, false});
+    cases.push_back({"playfair.decrypt", [=](const std::string& t) {
+        return Playfair(t, dictionary, "monarchy").decrypt().size(); }, unlimited, false});
+
+    cases.push_back({"caesar.suggestDecryptions", [=](const std::string& t) {
+        Caesar(t, dictionary).suggestDecryptions(5, "basic"); return t.size(); }, searchLimit, true});
+    cases.push_back({"vigenere.suggestDecryptions", [=](const std::string& t) {
+        Vigenere(t, dictionary, "lemon").suggestDecryptions(5, "basic"); return t.size(); }, searchLimit, true});
+    cases.push_back({"affine.suggestDecryptions", [=](const std::string& t) {
+        Affine(t, dictionary, 1, 0).suggestDecryptions(5, "basic"); return t.size(); }, searchLimit, true});
+    cases.push_back({"transposition.suggestDecryptions", [=](const std::string& t) {
+        Transposition transposition(t, dictionary);
+        transposition.setKey(7);
+        transposition.suggestDecryptions(5, "basic");
+        return t.size(); }, searchLimit, true});
+    cases.push_back({"playfair.suggestDecryptions", [=](const std::string& t) {
+        Playfair(t, dictionary, "monarchy").suggestDecryptions(5, "basic"); return t.size(); }, searchLimit, true});
+
+    // The input is a word list written to a temporary file once per size
+    cases.push_back({"dictionary.loadFromFile", [](const std::string& path) {
+        Dictionary loaded;
+        loaded.loadFromFile(path, '\n');
+        return static_cast<uint64_t>(loaded.size()); }, unlimited, false});
+    cases.push_back({"dictionary.isInDictionary", [=](const std::string& t) {
+        uint64_t hits = 0;
+        std::istringstream words(t);
+        std::string word;
+        while (words >> word) hits += dictionary->isInDictionary(word);
+        return hits; }, unlimited, false});
+    cases.push_back({"dictionary.countMatches", [=](const std::string& t) {
+        return static_cast<uint64_t>(dictionary->countMatches(t)); }, unlimited, false});
+
+    cases.push_back({"entropy.calculateFullMetrics", [](const std::string& t) {
+        return static_cast<uint64_t>(EntropyCalculator().calculateFullMetrics(t).shannonEntropy * 1e6); },
+        unlimited, false});
+    cases.push_back({"frequency.analyzeCharacterFrequencies", [](const std::string& t) {
+        FrequencyAnalyzer analyzer(t);
+        return static_cast<uint64_t>(analyzer.analyzeCharacterFrequencies().size() +
+                                     analyzer.calculateIndexOfCoincidence() * 1e6); }, unlimited, false});
+    cases.push_back({"frequency.analyzeTrigrams", [](const std::string& t) {
+        return static_cast<uint64_t>(FrequencyAnalyzer(t).analyzeTrigrams().size()); }, unlimited, false});
+    cases.push_back({"pattern.findRepeatingPatterns", [](const std::string& t) {
+        return static_cast<uint64_t>(PatternFinder(t).findRepeatingPatterns().size()); }, unlimited, false});
+    cases.push_back({"pattern.performKasiskiExamination", [](const std::string& t) {
+        return static_cast<uint64_t>(PatternFinder(t).performKasiskiExamination().possibleKeyLengths.size()); },
+        unlimited, false});
+    cases.push_back({"language.analyzeText", [=](const std::string& t) {
+        return static_cast<uint64_t>(matcher->analyzeText(t).confidence * 1e6); }, unlimited, false});
+    cases.push_back({"language.detectPossibleLanguages", [=](const std::string& t) {
+        return static_cast<uint64_t>(matcher->detectPossibleLanguages(t).size()); }, unlimited, false});
+    return cases;
+}
+
+std::string resultKey(const std::string& name, size_t bytes) {
+    return name + "@" + std::to_string(bytes);
+}
+
+std::map<std::string, Result> loadBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Cannot open baseline " + path);
+    std::map<std::string, Result> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        JsonRecord record = parseJsonRecord(line);
+        Result result;
+        result.name = record["name"].text;
+        result.bytes = std::stoull(record["bytes"].text);
+        result.medianNs = std::stod(record["median_ns"].text);
+        result.mbPerSecond = std::stod(record["mb_per_s"].text);
+        baseline[resultKey(result.name, result.bytes)] = result;
+    }
+    return baseline;
+}
+
+std::string toJson(const Result& result) {
+    return JsonRecordBuilder()
+        .add("name", result.name)
+        .add("bytes", result.bytes)
+        .add("runs", result.runs)
+        .add("min_ns", result.minNs)
+        .add("median_ns", result.medianNs)
+        .add("mean_ns", result.meanNs)
+        .add("mb_per_s", result.mbPerSecond)
+        .str();
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes = {1024, 16 * 1024, 256 * 1024};
+    std::string filter, jsonPath, baselinePath;
+    double minSeconds = 0.2;
+    double threshold = 10.0;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--sizes=", 0) == 0) {
+                sizes.clear();
+                std::istringstream list(arg.substr(8));
+                std::string size;
+                while (std::getline(list, size, ',')) sizes.push_back(parseSize(size));
+            } else if (arg.rfind("--filter=", 0) == 0) {
+                filter = arg.substr(9);
+            } else if (arg.rfind("--min-time=", 0) == 0) {
+                minSeconds = std::stod(arg.substr(11));
+            } else if (arg.rfind("--json=", 0) == 0) {
+                jsonPath = arg.substr(7);
+            } else if (arg.rfind("--baseline=", 0) == 0) {
+                baselinePath = arg.substr(11);
+            } else if (arg.rfind("--threshold=", 0) == 0) {
+                threshold = std::stod(arg.substr(12));
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n"
+                          << "Usage: fsct_bench [--sizes=1K,16K,256K] [--filter=text] [--min-time=seconds]\n"
+                          << "                  [--json=file] [--baseline=file] [--threshold=percent]\n";
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid option: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::map<std::string, Result> baseline;
+    if (!baselinePath.empty()) {
+        try {
+            baseline = loadBaseline(baselinePath);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to load baseline: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    Dictionary dictionary;
+    std::vector<std::string> wordList(WORDS, WORDS + WORD_COUNT);
+    LanguageMatcher matcher(wordList);
+    std::vector<Case> cases = buildCases(&dictionary, &matcher);
+
+    std::ofstream json;
+    if (!jsonPath.empty()) {
+        json.open(jsonPath);
+        if (!json.is_open()) {
+            std::cerr << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+    }
+
+    const std::string wordFilePath = "/tmp/fsct_bench_words_" + std::to_string(getpid()) + ".txt";
+    size_t regressions = 0;
+    std::printf("%-40s %6s %8s %12s %12s %10s", "benchmark", "size", "runs", "median us", "min us", "MB/s");
+    if (!baseline.empty()) std::printf(" %10s %8s", "base MB/s", "change");
+    std::printf("\n");
+
+    for (size_t size : sizes) {
+        const std::string text = makeText(size);
+        {
+            std::ofstream words(wordFilePath);
+            words << makeWordFile(size);
+        }
+
+        for (const Case& benchCase : cases) {
+            if (!filter.empty() && benchCase.name.find(filter) == std::string::npos) continue;
+            if (size > benchCase.maxBytes) continue;
+            bool loadsFile = benchCase.name == "dictionary.loadFromFile";
+            Result result = measure(benchCase, loadsFile ? wordFilePath : text, minSeconds);
+            if (loadsFile) {
+                result.bytes = size;
+                result.mbPerSecond = size / (result.medianNs / 1e9) / 1e6;
+            }
+
+            std::printf("%-40s %6s %8zu %12.2f %12.2f %10.2f", result.name.c_str(), sizeLabel(size).c_str(),
+                        result.runs, result.medianNs / 1e3, result.minNs / 1e3, result.mbPerSecond);
+            auto base = baseline.find(resultKey(result.name, result.bytes));
+            if (base != baseline.end()) {
+                // Positive change means slower than the baseline
+                double change = (result.medianNs / base->second.medianNs - 1.0) * 100.0;
+                const char* verdict = change > threshold ? "  REGRESSION" : change < -threshold ? "  faster" : "";
+                if (change > threshold) regressions++;
+                std::printf(" %10.2f %+7.1f%%%s", base->second.mbPerSecond, change, verdict);
+            } else if (!baseline.empty()) {
+                std::printf(" %10s %8s", "-", "new");
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+            if (json.is_open()) json << toJson(result) << "\n";
+        }
+    }
+    std::remove(wordFilePath.c_str());
+
+    if (!baseline.empty()) {
+        std::printf("%zu regression(s) beyond %.1f%% against %s\n", regressions, threshold, baselinePath.c_str());
+    }
+    return regressions > 0 ? 2 : 0;
+}
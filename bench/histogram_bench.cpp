@@ -0,0 +1,166 @@
+// Micro-benchmark: HistogramKernel against the per-character counting loops
+// it replaced in FrequencyAnalyzer, Dictionary and EntropyCalculator, plus
+// the two ways FrequencyAccumulator::add can combine letter and n-gram
+// counting. Sizes range from a short message to a large file, since fixed
+// per-call costs only show on small inputs.
+#include "../include/analysis/histogram.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+volatile uint64_t sink;
+
+std::string makeText(size_t length) {
+    std::mt19937_64 rng(42);
+    const char alphabet[] = "etaoinshrdlucmfwypvbgkjqxzETAOINSHRDLU   ,.";
+    std::string text(length, ' ');
+    for (auto& c : text) {
+        c = alphabet[rng() % (sizeof(alphabet) - 1)];
+    }
+    return text;
+}
+
+// Original FrequencyAnalyzer: normalize, then count into std::map<char, int>
+uint64_t legacyFrequencyAnalyzer(const std::string& text) {
+    std::string normalized;
+    for (char c : text) {
+        if (std::isalpha(c)) normalized += std::toupper(c);
+    }
+    std::map<char, int> charCount;
+    for (char c : normalized) {
+        if (c >= 'A' && c <= 'Z') charCount[c]++;
+    }
+    return charCount.size();
+}
+
+// Original Dictionary::indexOfCoincidenceOverSubstrings inner loop
+uint64_t legacyDictionary(const std::string& text) {
+    std::unordered_map<char, int> freq;
+    for (char c : text) {
+        if (std::isalpha(c)) freq[std::tolower(c)]++;
+    }
+    return freq.size();
+}
+
+// Original EntropyCalculator::calculateProbabilities
+uint64_t legacyEntropyCalculator(const std::string& text) {
+    std::map<char, double> probabilities;
+    double total = text.length();
+    for (char c : text) probabilities[c] += 1.0 / total;
+    return probabilities.size();
+}
+
+uint64_t kernelLetters(const std::string& text) {
+    std::array<uint64_t, 26> counts{};
+    return HistogramKernel::countLetters(text.data(), text.length(), counts);
+}
+
+uint64_t kernelBytes(const std::string& text) {
+    std::array<uint64_t, 256> counts{};
+    HistogramKernel::countBytes(text.data(), text.length(), counts);
+    return counts['e'];
+}
+
+// FrequencyAccumulator's letter, bigram and trigram state
+struct NGramCounts {
+    std::array<uint64_t, 26> letters{};
+    std::vector<uint64_t> bigrams = std::vector<uint64_t>(26 * 26);
+    std::vector<uint64_t> trigrams = std::vector<uint64_t>(26 * 26 * 26);
+    uint64_t total = 0;
+    uint8_t tail[2] = {0, 0};
+
+    void pushLetter(uint8_t letter) {
+        if (total >= 1) bigrams[tail[1] * 26 + letter]++;
+        if (total >= 2) trigrams[(tail[0] * 26 + tail[1]) * 26 + letter]++;
+        tail[0] = tail[1];
+        tail[1] = letter;
+        total++;
+    }
+};
+
+// Letters through the kernel, then a second pass for the n-grams
+uint64_t accumulatorTwoPass(const std::string& text) {
+    static NGramCounts counts;
+    HistogramKernel::countLetters(text.data(), text.length(), counts.letters);
+    for (unsigned char c : text) {
+        uint8_t letter = HistogramKernel::letterIndex(c);
+        if (letter != HistogramKernel::NOT_A_LETTER) counts.pushLetter(letter);
+    }
+    return counts.total;
+}
+
+// Letters counted in the same pass that feeds the n-grams
+uint64_t accumulatorSinglePass(const std::string& text) {
+    static NGramCounts counts;
+    for (unsigned char c : text) {
+        uint8_t letter = HistogramKernel::letterIndex(c);
+        if (letter != HistogramKernel::NOT_A_LETTER) {
+            counts.letters[letter]++;
+            counts.pushLetter(letter);
+        }
+    }
+    return counts.total;
+}
+
+// Best of three rounds, each repeating fn for at least 50 ms
+double measure(const std::string& text, const std::function<uint64_t(const std::string&)>& fn) {
+    double best = 0;
+    for (int round = 0; round < 3; ++round) {
+        size_t calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed{};
+        do {
+            sink = fn(text);
+            calls++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 0.05);
+        best = std::max(best, text.length() * calls / elapsed.count() / 1e6);
+    }
+    return best;
+}
+}
+
+int main() {
+    struct Case {
+        const char* name;
+        std::function<uint64_t(const std::string&)> fn;
+    };
+    const Case cases[] = {
+        {"legacy FrequencyAnalyzer (map<char,int>)", legacyFrequencyAnalyzer},
+        {"legacy Dictionary IoC (unordered_map)", legacyDictionary},
+        {"legacy EntropyCalculator (map<char,double>)", legacyEntropyCalculator},
+        {"HistogramKernel::countLetters", kernelLetters},
+        {"HistogramKernel::countBytes", kernelBytes},
+        {"accumulator: kernel, then n-gram pass", accumulatorTwoPass},
+        {"accumulator: letters in the n-gram pass", accumulatorSinglePass},
+    };
+    const size_t sizes[] = {64, 1 << 10, 64 << 10, 64 << 20};
+
+    std::printf("Histogram throughput in MB/s\n  %-46s", "");
+    for (size_t size : sizes) {
+        std::printf(" %10s", size >= (1 << 20) ? (std::to_string(size >> 20) + " MiB").c_str()
+                             : size >= (1 << 10) ? (std::to_string(size >> 10) + " KiB").c_str()
+                                                 : (std::to_string(size) + " B").c_str());
+    }
+    std::printf("\n");
+
+    std::vector<std::string> texts;
+    for (size_t size : sizes) texts.push_back(makeText(size));
+    for (const auto& c : cases) {
+        std::printf("  %-46s", c.name);
+        for (const auto& text : texts) {
+            std::printf(" %10.1f", measure(text, c.fn));
+            std::fflush(stdout);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
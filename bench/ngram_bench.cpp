@@ -0,0 +1,88 @@
+// Check and micro-benchmark: FrequencyAnalyzer::analyzeNGrams against the
+// std::map<std::string, NGramData> implementation it replaced. Every n-gram
+// must come back with the same count, frequency and positions; lengths on
+// both sides of the 13-letter packed-code limit are covered.
+#include "../include/analysis/entropy_calculator.hpp"
+#include "../include/analysis/frequency_analyzer.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// Upper-case letters built from a few repeated phrases, so long n-grams recur
+std::string makeText(size_t length) {
+    std::mt19937_64 rng(42);
+    const char* const phrases[] = {"ATTACKATDAWN", "THEQUICKBROWNFOX", "MEETMEATTHEBRIDGE", "SECRETMESSAGE"};
+    std::string text;
+    while (text.size() < length) {
+        if (rng() % 4 == 0) {
+            text += static_cast<char>('A' + rng() % 26);
+        } else {
+            text += phrases[rng() % 4];
+        }
+    }
+    text.resize(length);
+    return text;
+}
+
+// Original FrequencyAnalyzer::analyzeNGrams, keyed by sequence
+std::map<std::string, NGramData> legacyNGrams(const std::string& text, size_t n) {
+    EntropyCalculator entropyCalc;
+    std::map<std::string, NGramData> ngramMap;
+    auto ngramProbabilities = entropyCalc.calculateNGramProbabilities(text, n);
+    for (size_t i = 0; i <= text.length() - n; ++i) {
+        std::string sequence = text.substr(i, n);
+        if (ngramMap.find(sequence) == ngramMap.end()) {
+            ngramMap[sequence] = {sequence, 1, ngramProbabilities[sequence], {i}};
+        } else {
+            ngramMap[sequence].count++;
+            ngramMap[sequence].positions.push_back(i);
+        }
+    }
+    return ngramMap;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+int main() {
+    const size_t size = 1 << 18;
+    const std::string text = makeText(size);
+    FrequencyAnalyzer analyzer(text);
+    const size_t lengths[] = {2, 3, 5, 12, 13, 14, 16};
+    size_t failures = 0;
+
+    std::printf("analyzeNGrams against the map-based original over %zu KiB\n", size >> 10);
+    for (size_t n : lengths) {
+        auto start = std::chrono::steady_clock::now();
+        std::map<std::string, NGramData> expected = legacyNGrams(text, n);
+        double legacySeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<NGramData> actual = analyzer.analyzeNGrams(n);
+        double currentSeconds = secondsSince(start);
+
+        size_t mismatched = 0;
+        for (const auto& ngram : actual) {
+            auto it = expected.find(ngram.sequence);
+            if (it == expected.end() || it->second.count != ngram.count ||
+                it->second.positions != ngram.positions ||
+                std::fabs(it->second.frequency - ngram.frequency) > 1e-12) {
+                mismatched++;
+            }
+        }
+        mismatched += expected.size() > actual.size() ? expected.size() - actual.size() : 0;
+        failures += mismatched;
+
+        std::printf("  n=%-3zu %8zu n-grams  legacy %8.1f ms  current %8.1f ms  %s\n", n, actual.size(),
+                    legacySeconds * 1e3, currentSeconds * 1e3,
+                    mismatched == 0 ? "match" : "MISMATCH");
+    }
+    return failures == 0 ? 0 : 1;
+}
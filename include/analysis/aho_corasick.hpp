@@ -0,0 +1,61 @@
+#ifndef AHO_CORASICK_HPP
+#define AHO_CORASICK_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Multi-pattern matcher: every occurrence of every pattern is reported in a
+// single pass over the input. Bytes are mapped to a compact alphabet of the
+// symbols that appear in some pattern, so the fully resolved transition table
+// stays small even for hundreds of patterns.
+class AhoCorasick {
+public:
+    AhoCorasick();
+    explicit AhoCorasick(const std::vector<std::string>& patterns);
+
+    // Returns the pattern id (insertion order). Call build() after the last add.
+    size_t addPattern(const std::string& pattern);
+    void build();
+
+    size_t patternCount() const;
+    const std::string& getPattern(size_t id) const;
+
+    // Calls onMatch(patternId, startPosition) for every occurrence, overlapping
+    // ones included, in order of their end position.
+    template <typename Callback>
+    void scan(const char* data, size_t length, Callback&& onMatch) const;
+
+    // Occurrence start positions per pattern id, ascending
+    std::vector<std::vector<size_t>> findAll(const std::string& text) const;
+
+private:
+    std::vector<std::string> patterns;
+    std::array<uint16_t, 256> symbolClass;  // class 0 = byte used by no pattern
+    size_t alphabetSize;
+    std::vector<uint32_t> transitions;      // state * alphabetSize + class
+    std::vector<uint32_t> outputOffsets;    // CSR: ids ending at state s are
+    std::vector<uint32_t> outputIds;        //   outputIds[outputOffsets[s] .. outputOffsets[s + 1])
+    std::vector<uint32_t> outputLink;       // nearest proper suffix state with outputs, 0 if none
+    bool built;
+};
+
+template <typename Callback>
+void AhoCorasick::scan(const char* data, size_t length, Callback&& onMatch) const {
+    if (!built || transitions.empty()) return;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    uint32_t state = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        state = transitions[state * alphabetSize + symbolClass[bytes[i]]];
+        for (uint32_t s = state; s != 0; s = outputLink[s]) {
+            for (uint32_t k = outputOffsets[s]; k < outputOffsets[s + 1]; ++k) {
+                uint32_t id = outputIds[k];
+                onMatch(static_cast<size_t>(id), i + 1 - patterns[id].length());
+            }
+        }
+    }
+}
+
+#endif
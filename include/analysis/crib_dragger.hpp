@@ -0,0 +1,47 @@
+#ifndef CRIB_DRAGGER_HPP
+#define CRIB_DRAGGER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../dictionary/dictionary.hpp"
+
+// One crib placement reported by CribDragger; scores are in [0, 1]
+struct CribHit {
+    size_t position;          // offset of the crib in the ciphertext's letters
+    size_t textOffset;        // byte offset of that letter in the original ciphertext
+    std::string keyFragment;  // implied key letters under the crib ('a' = shift 0)
+    size_t period;            // best repeat distance inside keyFragment, 0 if none
+    std::string key;          // key aligned to the first letter of the text, empty if unknown
+    double periodicityScore;  // share of the fragment confirmed by repeating at period
+    double wordScore;         // how much the key looks like English or a dictionary word
+    double score;
+};
+
+// Known-plaintext attack: slides a crib over every letter offset of the
+// ciphertext and derives the key fragment each placement implies. Key
+// semantics match Vigenere: the key advances only on letters and 'a' is
+// shift 0, so a recovered key can be passed straight to the cipher.
+class CribDragger {
+public:
+    CribDragger(const std::string& ciphertext, Dictionary* dict = nullptr);
+
+    // Ranked placements for a Vigenere key; topN = 0 keeps all
+    std::vector<CribHit> dragVigenere(const std::string& crib, size_t topN = 10) const;
+    // Ranked placements for a single Caesar shift; the key is one letter
+    std::vector<CribHit> dragCaesar(const std::string& crib, size_t topN = 10) const;
+
+    // shifts[i] = (cipher[i] - plain[i]) mod 26 for letter indices 0-25
+    static void impliedShifts(const uint8_t* cipher, const uint8_t* plain, size_t length, uint8_t* shifts);
+
+private:
+    std::vector<uint8_t> letters;       // ciphertext letters as 0-25
+    std::vector<size_t> letterOffsets;  // byte offset of each letter
+    Dictionary* dictionary;
+
+    static std::vector<uint8_t> cribLetters(const std::string& crib);
+    double dictionaryCoverage(const std::string& unit, bool cyclic) const;
+    void refineAndRank(std::vector<CribHit>& hits, size_t topN) const;
+};
+
+#endif
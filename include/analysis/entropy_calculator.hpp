@@ -1,6 +1,8 @@
 #ifndef ENTROPY_CALCULATOR_HPP
 #define ENTROPY_CALCULATOR_HPP
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -16,6 +18,44 @@ struct EntropyMetrics {
     std::map<std::string, double> ngramEntropies;
 };
 
+// Bitmask of metrics requested from EntropyCalculator::calculateMetrics
+enum EntropyMetricFlags : unsigned {
+    METRIC_SHANNON = 1u << 0,
+    METRIC_NORMALIZED = 1u << 1,
+    METRIC_CONDITIONAL = 1u << 2,
+    METRIC_JOINT = 1u << 3,
+    METRIC_MUTUAL_INFORMATION = 1u << 4,
+    METRIC_RELATIVE = 1u << 5,
+    METRIC_CHARACTER_PROBABILITIES = 1u << 6,  // detail table, needs EntropyDetails
+    METRIC_NGRAM_ENTROPIES = 1u << 7,          // detail table, needs EntropyDetails
+    METRIC_ALL = 0xFFu
+};
+
+// Compact result of calculateMetrics; fields not named in `computed` are left at 0
+struct EntropySummary {
+    unsigned computed;
+    double shannonEntropy;
+    double normalizedEntropy;
+    double conditionalEntropy;
+    double jointEntropy;
+    double mutualInformation;
+    double relativeEntropy;
+};
+
+// Optional detail tables, filled only when requested
+struct EntropyDetails {
+    std::map<char, double> characterProbabilities;
+    std::map<std::string, double> ngramEntropies;
+};
+
+// Joint statistics of the pairs (text[i], text[i + lag])
+struct LaggedEntropy {
+    size_t lag;
+    double jointEntropy;
+    double conditionalEntropy;  // H(text[i + lag] | text[i])
+    double mutualInformation;
+};
+
 class EntropyCalculator {
 public:
     EntropyCalculator();
@@ -23,6 +63,8 @@ public:
     
     // Core entropy calculations
     EntropyMetrics calculateFullMetrics(const std::string& text) const;
+    EntropySummary calculateMetrics(const std::string& text, unsigned requested,
+                                    EntropyDetails* details = nullptr) const;
     double calculateShannon(const std::string& text) const;
     double calculateNormalizedEntropy(const std::string& text) const;
     double calculateConditionalEntropy(const std::string& text, const std::string& condition) const;
@@ -31,6 +73,8 @@ public:
     double calculateJointEntropy(const std::string& text1, const std::string& text2) const;
     double calculateMutualInformation(const std::string& text1, const std::string& text2) const;
     double calculateRelativeEntropy(const std::string& text, const std::string& referenceText) const;
+    // Lagged joint statistics for lags 1..maxLag; periodic keys show up as MI peaks
+    std::vector<LaggedEntropy> calculateLaggedEntropies(const std::string& text, size_t maxLag) const;
     
     // N-gram entropy analysis
     std::map<std::string, double> calculateNGramEntropies(const std::string& text, size_t n) const;
@@ -46,10 +90,25 @@ public:
     double calculateLog2(double value) const;
     std::vector<std::string> extractNGrams(const std::string& text, size_t n) const;
 private:
+    using ByteCounts = std::array<uint64_t, 256>;
+    using JointCounts = std::vector<uint32_t>;  // dense 256x256, row = first symbol
+
     std::map<char, double> referenceDistribution;
     
     
     void initializeReferenceDistribution(const std::string& text);
+
+    // Histogram-based kernels shared by the public metrics
+    static void countBytes(const char* data, size_t length, ByteCounts& counts);
+    double entropyFromCounts(const ByteCounts& counts, size_t total) const;
+    double relativeEntropyFromCounts(const ByteCounts& countsP, size_t totalP,
+                                     const ByteCounts& countsQ, size_t totalQ) const;
+    static void fillJointCounts(const char* first, const char* second, size_t length, JointCounts& joint);
+    static void marginalsFromJoint(const JointCounts& joint, ByteCounts& rows, ByteCounts& columns);
+    double jointEntropyFromCounts(const JointCounts& joint, size_t total) const;
+    double jointEntropyOfRanges(const char* first, const char* second, size_t length) const;
+    double conditionalEntropyWithCounts(const std::string& text, const std::string& condition,
+                                        const ByteCounts& conditionCounts) const;
 };
 
 #endif
@@ -0,0 +1,58 @@
+#ifndef ENTROPY_PROFILER_HPP
+#define ENTROPY_PROFILER_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+struct WindowProfile {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t letterCount;
+    double byteEntropy;         // bits per byte, 0..8
+    double letterEntropy;       // bits per letter, 0..log2(26)
+    double indexOfCoincidence;  // over case-folded letters only
+};
+
+// Sliding-window entropy/IoC profile over a byte stream.
+// Histograms are updated incrementally as the window slides, so memory use
+// is bounded by the window size no matter how large the input is.
+class EntropyProfiler {
+public:
+    EntropyProfiler(size_t windowSize, size_t stepSize);
+
+    // Stream input and call emit once per window; returns the number of windows.
+    // Inputs shorter than one window produce a single partial window. When the
+    // steps do not land on the last byte, a final full window ending there is
+    // added, so its offset need not be a multiple of the step.
+    size_t profileStream(std::istream& in, const std::function<void(const WindowProfile&)>& emit);
+    size_t profileFile(const std::string& path, const std::function<void(const WindowProfile&)>& emit);
+
+    // Output helpers used by `fsct entropy`
+    static void writeCsvHeader(std::ostream& out);
+    static void writeCsvRow(std::ostream& out, const WindowProfile& profile);
+    static void writeBinaryHeader(std::ostream& out, size_t windowSize, size_t stepSize);
+    static void writeBinaryRecord(std::ostream& out, const WindowProfile& profile);
+
+    size_t getWindowSize() const;
+    size_t getStepSize() const;
+
+private:
+    size_t windowSize;
+    size_t stepSize;
+    std::vector<unsigned char> ring;
+    std::array<uint32_t, 256> byteCounts;
+    std::array<uint32_t, 26> letterCounts;
+    uint32_t letterTotal;
+    std::vector<double> countLog2Table;  // c * log2(c) for c in [0, windowSize]
+
+    void reset();
+    void addByte(unsigned char b);
+    void removeByte(unsigned char b);
+    WindowProfile snapshot(uint64_t offset, uint32_t length) const;
+};
+
+#endif
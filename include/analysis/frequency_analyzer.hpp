@@ -6,6 +6,7 @@
 #include <map>
 #include <utility>
 #include <array>
+#include <cstdint>
 #include "entropy_calculator.hpp"
 
 struct FrequencyData {
@@ -23,9 +24,63 @@ struct NGramData {
     std::vector<size_t> positions;  // Unique to FrequencyAnalyzer
 };
 
+// N-gram occurrences in CSR layout. The n-gram packed as codes[k] (base 26,
+// most significant letter first) occurs counts[k] times, at
+// positions[offsets[k]] .. positions[offsets[k] + counts[k] - 1] in ascending order.
+struct NGramTable {
+    size_t n;
+    size_t totalNGrams;
+    std::vector<uint64_t> codes;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> positions;
+
+    size_t size() const;
+    std::string sequence(size_t k) const;
+};
+
+// Mergeable letter, bigram and trigram counts over case-folded A-Z.
+// Chunks of a large input can be counted independently and merged in stream
+// order; n-grams straddling a chunk boundary are recovered from the first and
+// last two letters each accumulator keeps.
+class FrequencyAccumulator {
+public:
+    FrequencyAccumulator();
+
+    // Append raw bytes to the stream; non-letters are skipped
+    void add(const char* data, size_t length);
+    void add(const std::string& text);
+
+    // Fold in the counts of the chunk that immediately follows this one
+    void merge(const FrequencyAccumulator& next);
+
+    // Split a buffer or file into chunks, count them on all cores and reduce
+    static FrequencyAccumulator countParallel(const char* data, size_t length, size_t threads = 0);
+    static FrequencyAccumulator countFile(const std::string& path, size_t threads = 0);
+
+    uint64_t totalLetters() const;
+    uint64_t letterCount(int letter) const;
+    uint64_t bigramCount(int first, int second) const;
+    uint64_t trigramCount(int first, int second, int third) const;
+    uint64_t coincidencePairs() const;  // sum of c * (c - 1), the IoC numerator
+    const std::array<uint64_t, 26>& getLetterCounts() const;
+
+private:
+    std::array<uint64_t, 26> letters;
+    std::vector<uint64_t> bigrams;   // 26 * 26
+    std::vector<uint64_t> trigrams;  // 26 * 26 * 26
+    uint64_t total;
+    std::array<uint8_t, 2> head;     // first two letters, valid up to min(total, 2)
+    std::array<uint8_t, 2> tail;     // last two letters, tail[1] is the most recent
+
+    void pushLetter(uint8_t letter);  // n-gram and head/tail bookkeeping only
+};
+
 class FrequencyAnalyzer {
 public:
     FrequencyAnalyzer(const std::string& text);
+    // Analyze pre-merged counts; n-gram position tracking is unavailable in this mode
+    explicit FrequencyAnalyzer(const FrequencyAccumulator& counts);
     
     // Core frequency analysis
     std::vector<FrequencyData> analyzeCharacterFrequencies() const;
@@ -36,6 +91,10 @@ public:
     std::vector<NGramData> analyzeBigrams() const;
     std::vector<NGramData> analyzeTrigrams() const;
     std::vector<NGramData> analyzeNGrams(size_t n) const;
+    // Longest n-gram whose base-26 code fits in 64 bits (26^13 < 2^64)
+    static constexpr size_t MAX_PACKED_NGRAM = 13;
+    // Throws std::invalid_argument if n > MAX_PACKED_NGRAM
+    NGramTable buildNGramTable(size_t n) const;
     
     // Statistical measures specific to frequency analysis
     double calculateIndexOfCoincidence() const;
@@ -52,6 +111,7 @@ public:
 
 private:
     std::string text;
+    FrequencyAccumulator counts;
     static const std::array<double, 26> ENGLISH_FREQUENCIES;
     EntropyCalculator entropyCalc;  // For any entropy-related calculations
     
@@ -59,6 +119,8 @@ private:
     std::string normalizeText(const std::string& input) const;
     bool isValidChar(char c) const;
     std::vector<FrequencyData> calculateDeviations(const std::vector<FrequencyData>& data) const;
+    std::vector<NGramData> ngramsFromCounts(size_t n) const;
+    std::vector<NGramData> ngramsBySubstring(size_t n) const;
     double calculateFrequency(int count, size_t total) const;
 };
 
@@ -0,0 +1,47 @@
+#ifndef GRAMMAR_MATCHER_HPP
+#define GRAMMAR_MATCHER_HPP
+
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Grammar patterns compiled once and evaluated together in one pass over
+// the word tokens (runs of [A-Za-z0-9_]) of a text. Two regex shapes are
+// recognised and matched at token level with the same results as std::regex:
+//   \b(w1|w2|...)\s+\w+   a listed word, whitespace, then any word
+//   \b\w+SUFFIX\b         a word ending in SUFFIX
+// Any other pattern falls back to a std::regex compiled once.
+class GrammarMatcher {
+public:
+    GrammarMatcher();
+
+    // Patterns are numbered in the order they are added
+    void addPattern(const std::string& pattern);
+    void clear();
+    size_t patternCount() const;
+
+    // counts[i] = number of non-overlapping matches of pattern i in text
+    std::vector<size_t> countMatches(const std::string& text) const;
+
+private:
+    enum RuleKind { WORD_THEN_WORD, SUFFIX, REGEX };
+
+    struct Rule {
+        RuleKind kind;
+        std::string suffix;  // SUFFIX rules
+        std::regex regex;    // REGEX rules
+    };
+
+    std::vector<Rule> rules;
+    std::vector<size_t> wordRules;    // indices of WORD_THEN_WORD rules
+    std::vector<size_t> suffixRules;  // indices of SUFFIX rules
+    std::vector<size_t> regexRules;   // indices of REGEX rules
+    // Leading word -> WORD_THEN_WORD rules it starts
+    std::unordered_map<std::string, std::vector<size_t>> leadWords;
+
+    static bool parseWordThenWord(const std::string& pattern, std::vector<std::string>& words);
+    static bool parseSuffix(const std::string& pattern, std::string& suffix);
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Shared histogram kernels used by every statistical test in fsct.
+// Counting is spread over interleaved banks so consecutive equal bytes do not
+// serialize on the same counter.
+class HistogramKernel {
+public:
+    static constexpr uint8_t NOT_A_LETTER = 26;
+
+    // Add the byte counts of data to counts
+    static void countBytes(const char* data, size_t length, std::array<uint64_t, 256>& counts);
+
+    // Add the counts of case-folded ASCII letters A-Z; returns the number of letters seen
+    static uint64_t countLetters(const char* data, size_t length, std::array<uint64_t, 26>& counts);
+
+    // Letter index 0-25 for A-Z/a-z, NOT_A_LETTER otherwise; inline because
+    // per-byte loops call it for every input byte
+    static uint8_t letterIndex(unsigned char c) { return LETTER_INDEX[c]; }
+
+private:
+    static const std::array<uint8_t, 256> LETTER_INDEX;
+};
+
+#endif
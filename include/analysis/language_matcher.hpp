@@ -5,10 +5,14 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <cstdint>
 #include <memory>
 #include <future>
 #include <numeric>
 #include "entropy_calculator.hpp" 
+#include "grammar_matcher.hpp"
+#include "ngram_language_model.hpp"
 struct LanguageProfile {
     std::string name;
     std::map<std::string, double> wordFrequencies;
@@ -27,10 +31,18 @@ struct MatchResult {
 
 class LanguageMatcher {
 public:
+    // How detectPossibleLanguages scores languages
+    enum LanguageBackend {
+        WORD_FREQUENCY_BACKEND,   // whole-word frequencies of each profile
+        CHARACTER_NGRAM_BACKEND   // naive Bayes over character 1-4-grams; returns posteriors
+    };
+
     // Constructors for different dictionary sources
     LanguageMatcher(const std::string& dictionaryFilePath);
     LanguageMatcher(const std::vector<std::string>& wordList);
     LanguageMatcher(bool downloadDict);
+    // Word list from an http(s):// or file:// source, through the local dictionary cache
+    LanguageMatcher(bool downloadDict, const std::string& dictionarySource);
     // Core analysis methods
     std::map<std::string, double> analyzeNGramDistribution(const std::string& text, size_t n) const;
     MatchResult analyzeText(const std::string& text) const;
@@ -41,6 +53,10 @@ public:
     void addLanguageProfile(const LanguageProfile& profile);
     void loadLanguageRules(const std::string& rulesFile);
     std::vector<std::pair<std::string, double>> detectPossibleLanguages(const std::string& text) const;
+    void setLanguageBackend(LanguageBackend backend);
+    // Train the character model of a language on sample text; profiles added
+    // with addLanguageProfile also train it from their word frequencies
+    void trainCharacterModel(const std::string& language, const std::string& sampleText);
     
     // Dictionary management
     void updateDictionary(const std::string& word);
@@ -58,13 +74,30 @@ private:
     std::set<std::string> dictionary;
     std::vector<LanguageProfile> languageProfiles;
     std::map<std::string, std::vector<std::string>> grammarPatterns;
-    bool downloadDictionary();
+    // grammarPatterns compiled in map order; rebuilt whenever the patterns change
+    GrammarMatcher grammarMatcher;
+    // Word frequencies of all profiles over one shared vocabulary, stored
+    // word-major: row vocabularyIds[w] holds one column per profile.
+    std::unordered_map<std::string, uint32_t> vocabularyIds;
+    std::vector<double> profileWeights;
+    std::vector<uint8_t> profileMembership;  // 1 where the profile lists the word
+    std::vector<NGramLanguageModel> characterModels;
+    LanguageBackend languageBackend = WORD_FREQUENCY_BACKEND;
+    bool downloadDictionary(const std::string& source);
     void mergeDictionary(const std::set<std::string>& newWords);
     // Helper methods
     std::vector<std::string> tokenizeText(const std::string& text) const;
     std::string normalizeWord(const std::string& word) const;
     bool loadDictionaryFromFile(const std::string& filePath);
     void initializeDefaultPatterns();
+    void compileGrammarPatterns();
+    void compileLanguageProfiles();
+    // Occurrences of each known vocabulary word among the tokens, as (id, count)
+    std::vector<std::pair<uint32_t, uint32_t>> countVocabulary(const std::vector<std::string>& words) const;
+    double wordFrequencyScore(const std::vector<std::string>& words) const;
+    NGramLanguageModel& characterModel(const std::string& language);
+    std::vector<std::pair<std::string, double>> detectByCharacterModels(const std::string& text) const;
+    double grammarScoreFromCounts(const std::vector<size_t>& counts) const;
     double calculateWordSimilarity(const std::string& word1, const std::string& word2) const;
 };
 
@@ -0,0 +1,51 @@
+#ifndef NGRAM_LANGUAGE_MODEL_HPP
+#define NGRAM_LANGUAGE_MODEL_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Character 1-4-gram model of one language for naive Bayes identification.
+// Letters are folded to 26 symbols plus a word-boundary symbol, so it works
+// on unspaced cipher output as well as ordinary text. Each n-gram is packed
+// into a 20-bit code (5 bits per symbol) and the most frequent ones are kept
+// in a fixed-size open-addressing table of 32-bit slots: code << 8 | q, where
+// q is the quantized log-probability. At the default size a model is 16 KB.
+class NGramLanguageModel {
+public:
+    static constexpr size_t MAX_ORDER = 4;
+    static constexpr size_t DEFAULT_TABLE_SIZE = 4096;
+
+    explicit NGramLanguageModel(const std::string& name, size_t tableSize = DEFAULT_TABLE_SIZE);
+
+    // Add every n-gram of text with the given weight and rebuild the table
+    void train(const std::string& text, double weight = 1.0);
+    // Add one word, padded with boundaries, without rebuilding the table
+    void addWord(const std::string& word, double weight);
+    // Rebuild the compact table from the training counts
+    void finalize();
+
+    // Sum of log-probabilities of every n-gram of text under this model
+    double logLikelihood(const std::string& text) const;
+    const std::string& getName() const;
+    size_t storedNGrams() const;
+
+private:
+    std::string name;
+    size_t tableBits;
+    std::vector<uint32_t> slots;           // 0 = empty
+    double quantStep;                      // log-probability per quantization level
+    double unseenLogProb[MAX_ORDER + 1];   // per order, for n-grams not in the table
+    size_t stored;
+
+    // Training state, kept so the model can be extended after finalize()
+    std::unordered_map<uint32_t, double> trainingCounts;
+    double orderTotals[MAX_ORDER + 1];
+
+    void countSymbols(const std::vector<uint8_t>& symbols, double weight);
+    bool lookup(uint32_t code, uint8_t& quantized) const;
+    size_t slotFor(uint32_t code) const;
+};
+
+#endif
@@ -5,6 +5,9 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <functional>
+#include <cstdint>
+#include "suffix_array.hpp"
 
 struct Pattern {
     std::string sequence;
@@ -18,13 +21,42 @@ struct KasiskiResult {
     std::map<int, int> spacingFrequencies;
 };
 
+// One entry of PatternFinder::rankKeyLengths; every score is in [0, 1]
+struct KeyLengthCandidate {
+    size_t length;
+    double confidence;            // weighted blend of the three scores below
+    double kasiskiScore;          // share of weighted repeat spacings divisible by length
+    double iocScore;              // mean column IoC, 0 = random text, 1 = English
+    double autocorrelationScore;  // coincidence rate at this shift, same scale as iocScore
+};
+
+// A maximal repeat as seen by PatternFinder::forEachMaximalRepeat.
+// positions points into a scratch buffer valid only during the callback.
+struct RepeatView {
+    size_t length;
+    const uint32_t* positions;  // ascending
+    size_t occurrences;
+};
+
 class PatternFinder {
 public:
     PatternFinder(const std::string& text);
     
     // Main analysis methods
     std::vector<Pattern> findRepeatingPatterns(size_t minLength = 3, size_t maxLength = 10) const;
+    // Every repeat that cannot be extended left or right, of any length >= minLength
+    std::vector<Pattern> findMaximalRepeats(size_t minLength = 3) const;
+    // Streaming form of findMaximalRepeats; return false from visit to stop early
+    void forEachMaximalRepeat(size_t minLength, const std::function<bool(const RepeatView&)>& visit) const;
     KasiskiResult performKasiskiExamination(size_t minLength = 3) const;
+    // Ranked shortlist of likely Vigenere key lengths in [2, maxKeyLength]; topN = 0 keeps all
+    std::vector<KeyLengthCandidate> rankKeyLengths(size_t maxKeyLength = 20, size_t minLength = 3,
+                                                   size_t topN = 5) const;
+    // counts[s] = number of i with text[i] == text[i + s], for s in 1..maxShift (counts[0] unused)
+    std::vector<size_t> computeCoincidenceCounts(size_t maxShift) const;
+    // Period estimate from the coincidence profile alone; fills autocorrelationScore and confidence
+    std::vector<KeyLengthCandidate> estimatePeriodByAutocorrelation(size_t maxShift = 40,
+                                                                    size_t topN = 5) const;
     std::vector<std::string> findAnagrams() const;
     std::map<char, std::vector<size_t>> findLetterSpacing() const;
     double calculatePatternDensity() const;
@@ -36,14 +68,21 @@ public:
     // Utility methods
     bool isValidPattern(const std::string& pattern) const;
     std::vector<size_t> findAllOccurrences(const std::string& pattern) const;
+    // Every occurrence of every pattern in one pass over the text. Patterns are
+    // normalized like the text (letters only, uppercase) and keyed by that form.
+    std::map<std::string, std::vector<size_t>> findAllOccurrences(const std::vector<std::string>& patterns) const;
     
 private:
     std::string text;
+    SuffixArray suffixArray;
     
     // Helper methods
     std::vector<int> calculateSpacings(const std::vector<size_t>& positions) const;
     std::vector<int> findFactors(int number) const;
     bool isPotentialKey(int spacing) const;
+    std::vector<double> weightedSpacingVotes(size_t maxKeyLength, size_t minLength, double& totalWeight) const;
+    double averageColumnIoC(size_t period) const;
+    size_t countCoincidences(size_t shift) const;
     std::string normalizeText(const std::string& input) const;
 };
 
@@ -0,0 +1,28 @@
+#ifndef SUFFIX_ARRAY_HPP
+#define SUFFIX_ARRAY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Suffix array (SA-IS, linear time) with its LCP array (Kasai).
+// lcp[i] is the longest common prefix of the suffixes at ranks i - 1 and i;
+// lcp[0] is 0.
+class SuffixArray {
+public:
+    SuffixArray();
+    explicit SuffixArray(const std::string& text);
+
+    const std::vector<uint32_t>& getSuffixes() const;
+    const std::vector<uint32_t>& getLcp() const;
+    size_t size() const;
+
+private:
+    std::vector<uint32_t> suffixes;
+    std::vector<uint32_t> lcp;
+
+    static std::vector<int> buildSuffixArray(const std::vector<int>& symbols, int upper);
+    void buildLcp(const std::string& text);
+};
+
+#endif
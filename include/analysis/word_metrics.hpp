@@ -5,6 +5,9 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <string_view>
+#include <cstdint>
+#include "aho_corasick.hpp"
 
 struct WordMetricsResult {
     double averageWordLength;
@@ -46,6 +49,8 @@ public:
     std::vector<std::string> getMostComplexWords(const std::string& text, size_t n) const;
     std::map<std::string, size_t> getSyllableCounts(const std::vector<std::string>& words) const;
     std::vector<std::string> extractMorphemes(const std::string& word) const;
+    // Common affixes occurring in the word, in affix order
+    std::vector<std::string> findAffixes(const std::string& word) const;
     
     // Distribution analysis
     std::map<size_t, size_t> getWordLengthDistribution(const std::string& text) const;
@@ -62,13 +67,49 @@ public:
     size_t countSyllables(const std::string& word) const;
 
 private:
+    // Tokens of one text, each distinct token interned once with its count.
+    // Views point into the analysed text and are valid only while it lives.
+    struct InternedText {
+        std::vector<std::string_view> words;     // distinct tokens, in first-seen order
+        std::vector<size_t> counts;              // occurrences of words[i]
+        std::vector<uint32_t> normalizedIds;     // words[i] -> index into normalizedWords
+        std::vector<std::string> normalizedWords;
+        std::vector<size_t> normalizedCounts;    // occurrences of normalizedWords[j]
+        size_t tokenCount = 0;
+        size_t totalLength = 0;
+        mutable std::vector<uint32_t> syllables;  // per words[i], filled by syllableCounts
+    };
+
+    // Everything one scan of a normalized word finds
+    struct MorphemeScan {
+        std::vector<std::string> morphemes;   // as findMorphemePatterns reports them
+        std::vector<std::string> components;  // as decomposeCompoundWord reports them
+        std::vector<std::string> affixes;
+    };
+
+    // What an automaton pattern stands for
+    enum MatchRole : uint8_t { MORPHEME_MATCH, COMPONENT_MATCH, AFFIX_MATCH };
+    struct MatchTarget {
+        MatchRole role;
+        uint32_t slot;  // morpheme, group or affix index, in configuration order
+    };
+
     // Configuration
     std::map<std::string, std::vector<std::string>> morphemePatterns;
     std::set<std::string> commonAffixes;
     std::map<std::string, size_t> syllableRules;
+
+    // Morphemes, pattern group names and affixes compiled into one automaton
+    AhoCorasick morphemeMatcher;
+    std::vector<MatchTarget> matchTargets;  // by automaton pattern id
+    std::vector<std::string> morphemeSlots;
+    std::vector<std::string> componentSlots;
+    std::vector<std::string> affixSlots;
     
     // Helper methods
-    std::vector<std::string> tokenizeText(const std::string& text) const;
+    InternedText internTokens(const std::string& text) const;
+    size_t syllablesIn(std::string_view word) const;
+    const std::vector<uint32_t>& syllableCounts(const InternedText& interned) const;
     std::string normalizeWord(const std::string& word) const;
     bool isVowel(char c) const;
     bool isConsonant(char c) const;
@@ -78,6 +119,15 @@ private:
     std::vector<std::string> findMorphemePatterns(const std::string& word) const;
     size_t countMorphemes(const std::string& word) const;
     
+    // Metrics over an interned text; the public text overloads wrap these
+    double averageWordLength(const InternedText& interned) const;
+    double typeTokenRatio(const InternedText& interned) const;
+    double vocabularyRichness(const InternedText& interned) const;
+    double readabilityScore(const InternedText& interned) const;
+    std::vector<std::string> mostComplexWords(const InternedText& interned, size_t n) const;
+    std::map<size_t, size_t> wordLengthDistribution(const InternedText& interned) const;
+    std::map<std::string, size_t> wordFrequencyDistribution(const InternedText& interned) const;
+
     // Statistical helpers
     double calculateStandardDeviation(const std::vector<double>& values) const;
     double calculateMean(const std::vector<double>& values) const;
@@ -85,6 +135,9 @@ private:
     // Configuration methods
     void loadLanguageConfig(const std::string& configPath);
     void initializeDefaultPatterns();
+    void compileMorphemeMatcher();
+    MorphemeScan scanMorphemes(const std::string& normalized) const;
+    double complexityFrom(size_t syllables, const MorphemeScan& scan) const;
 };
 
 #endif
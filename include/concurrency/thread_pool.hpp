@@ -0,0 +1,103 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Shared cancellation flag; copies observe the same state
+class CancellationToken {
+public:
+    CancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+// Work-stealing pool. Each worker owns a deque: it pops its own newest task
+// and, when that runs dry, steals the oldest task of another worker. Threads
+// waiting on a TaskGroup run queued tasks instead of blocking, so groups may
+// be nested inside tasks without deadlocking.
+class ThreadPool {
+public:
+    // threads = 0 uses the hardware concurrency
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+
+    // Fire-and-forget task; exceptions it throws are discarded
+    void submit(std::function<void()> task);
+
+    // Runs one queued task on the calling thread; false if none was available
+    bool runPendingTask();
+
+    // Calls body(begin, end) on chunks of at most grain indices covering
+    // [0, count) and returns once all have run. Chunks not yet started are
+    // skipped after token is cancelled. Exceptions are rethrown here.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body,
+                     const CancellationToken& token = CancellationToken());
+
+    // Process-wide pool shared by every analysis, created on first use
+    static ThreadPool& global();
+    // Size of the global pool; must be called before its first use
+    static void setGlobalThreadCount(size_t threads);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> nextQueue;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    bool popTask(size_t home, std::function<void()>& task);
+    void workerLoop(size_t index);
+};
+
+// Tracks a batch of related tasks. wait() helps run queued work until all of
+// the group's tasks have finished and rethrows the first exception any threw.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::global(),
+                       const CancellationToken& token = CancellationToken());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Tasks submitted after cancellation, or still queued when it happens, are skipped
+    void run(std::function<void()> task);
+    void wait();
+    void cancel();
+    const CancellationToken& token() const;
+
+private:
+    ThreadPool& pool;
+    CancellationToken cancellation;
+    std::atomic<size_t> outstanding;
+    std::mutex stateMutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+#endif
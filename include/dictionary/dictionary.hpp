@@ -33,6 +33,9 @@ public:
     // Load a dictionary from a file.
     bool loadFromFile(const std::string& filename, char delimiter);
 
+    // Load a one-word-per-line list from an http(s):// or file:// source via the dictionary cache.
+    bool loadFromSource(const std::string& source);
+
     // add a word to the dictionary
     void addWord(const std::string& word);
 
@@ -72,6 +75,9 @@ public:
     // return the number of words in the dictionary
     int size() const;
 
+    // return every word in the dictionary, sorted
+    std::vector<std::string> getWords() const;
+
     // return the longest word in the dictionary
     std::string getLongestWord() const;
 
@@ -0,0 +1,44 @@
+#ifndef DICTIONARY_CACHE_HPP
+#define DICTIONARY_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Word lists fetched from a source URL (http://, https:// or file://) and
+// kept in a local content-addressed cache. Each distinct list is compiled
+// once into a sorted binary file named by the FNV-1a hash of its raw
+// content, and a small ref file maps the source URL to that hash. Later runs
+// load the compiled list directly: remote sources need no network once
+// cached, and local sources are hashed but not parsed again.
+//
+// Compiled layout (little-endian): "FSCTDIC1", uint64 word count, uint64 blob
+// size, uint32 offsets[count + 1], then the words back to back.
+class DictionaryCache {
+public:
+    explicit DictionaryCache(const std::string& cacheDirectory = defaultDirectory());
+
+    // $FSCT_CACHE_DIR, else $XDG_CACHE_HOME/fsct, else $HOME/.cache/fsct
+    static std::string defaultDirectory();
+
+    // Sorted, de-duplicated, lowercase letters-only words of the source.
+    // Throws std::runtime_error if the source is neither cached nor reachable.
+    std::vector<std::string> load(const std::string& source);
+
+    static uint64_t fnv1a(const char* data, size_t length);
+
+private:
+    std::string directory;
+
+    std::string objectPath(uint64_t contentHash) const;
+    std::string refPath(const std::string& source) const;
+    bool readRef(const std::string& source, uint64_t& contentHash) const;
+    void writeRef(const std::string& source, uint64_t contentHash) const;
+
+    static std::string fetch(const std::string& source);
+    static std::vector<std::string> compileWords(const std::string& content);
+    static bool readCompiled(const std::string& path, std::vector<std::string>& words);
+    static void writeCompiled(const std::string& path, const std::vector<std::string>& words);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "cipher_engine.hpp"
+#include "../concurrency/thread_pool.hpp"
+
+// Values used for fields a batch record leaves out
+struct BatchDefaults {
+    std::string cipher;
+    std::string mode = "crack";
+    std::string key;
+};
+
+struct BatchSummary {
+    size_t records = 0;
+    size_t failed = 0;
+};
+
+// Runs a JSON Lines stream of cipher jobs. Each non-blank input line is an
+// object with "text" and optionally "id", "cipher", "mode" and "key"; each
+// produces one output line, in input order:
+//   {"line":N,"id":...,"ok":true,"cipher":...,"mode":...,"key":...,"score":...,"text":...}
+//   {"line":N,"id":...,"ok":false,"error":...}
+// Input is read a window at a time, so memory stays bounded however long
+// the stream is.
+class BatchRunner {
+public:
+    BatchRunner(const CipherEngine& engine, ThreadPool& pool = ThreadPool::global());
+
+    BatchSummary run(std::istream& in, std::ostream& out, const BatchDefaults& defaults) const;
+
+private:
+    const CipherEngine& engine;
+    ThreadPool& pool;
+
+    std::string processLine(const std::string& line, size_t lineNumber, const BatchDefaults& defaults,
+                            bool& ok) const;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef CIPHER_CLIENT_HPP
+#define CIPHER_CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+#include "cipher_engine.hpp"
+
+// Blocking client for a CipherServer socket, one request in flight at a time
+class CipherClient {
+public:
+    // Throws std::runtime_error if the server cannot be reached
+    explicit CipherClient(const std::string& socketPath);
+    ~CipherClient();
+
+    CipherClient(const CipherClient&) = delete;
+    CipherClient& operator=(const CipherClient&) = delete;
+
+    // Throws std::runtime_error if the connection fails mid-request
+    CipherJobResult call(const CipherJob& job);
+
+private:
+    int fd;
+    uint64_t nextId;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef CIPHER_ENGINE_HPP
+#define CIPHER_ENGINE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../dictionary/dictionary.hpp"
+
+// One unit of cipher work, independent of how it arrived
+struct CipherJob {
+    std::string cipher;  // caesar, vigenere, affine, transposition or playfair
+    std::string mode;    // encrypt, decrypt or crack
+    std::string key;     // caesar/transposition: integer (columns <= text length), affine: "a,b", others: letters
+    std::string text;
+};
+
+struct CipherJobResult {
+    bool ok = false;
+    std::string error;
+    std::string output;  // transformed text, or the best plaintext when cracking
+    std::string key;     // key used, or the recovered key when cracking
+    double score = 0.0;  // plaintext score in [0, 1]; set when cracking
+};
+
+// Runs cipher jobs against one shared dictionary and scoring model. All
+// state is fixed after construction, so a single engine can serve any
+// number of threads at once.
+//
+// Cracking is supported for caesar, affine and vigenere. Candidate keys are
+// ranked cheaply by English letter likelihood and only the best few are
+// scored against the dictionary.
+class CipherEngine {
+public:
+    explicit CipherEngine(std::shared_ptr<Dictionary> dictionary);
+
+    // Never throws; problems with the job are reported in the result
+    CipherJobResult run(const CipherJob& job) const;
+
+    // 0.5 * letter likelihood + 0.5 * share of words found in the dictionary
+    double scorePlaintext(const std::string& text) const;
+
+private:
+    std::shared_ptr<Dictionary> dictionary;
+    double logFrequency[26];
+    double randomMean;   // mean log-frequency of uniformly random letters
+    double englishMean;  // mean log-frequency of English letters
+
+    struct Candidate {
+        std::string key;
+        double likelihood;
+    };
+
+    CipherJobResult execute(const CipherJob& job) const;
+    CipherJobResult transform(const CipherJob& job, bool encrypt) const;
+    CipherJobResult crackCaesar(const std::string& text) const;
+    CipherJobResult crackAffine(const std::string& text) const;
+    CipherJobResult crackVigenere(const std::string& text) const;
+    CipherJobResult pickBest(const std::string& cipher, const std::string& text,
+                             std::vector<Candidate>& candidates, size_t refine) const;
+    std::string decryptWith(const std::string& cipher, const std::string& text, const std::string& key) const;
+    double letterScore(const std::string& text) const;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef CIPHER_SERVER_HPP
+#define CIPHER_SERVER_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cipher_engine.hpp"
+#include "frame_protocol.hpp"
+#include "../concurrency/bounded_queue.hpp"
+
+// Serves CipherEngine jobs over a Unix domain socket using frame_protocol.
+// One reader thread per connection decodes requests into a bounded queue
+// drained by a fixed set of workers; when the queue is full readers block,
+// so a client that sends faster than the workers keep up is slowed down by
+// the socket rather than growing the server's memory. In the other direction,
+// a response write that makes no progress for a few seconds drops its
+// connection, so a client that never reads cannot hold the workers, and
+// connections past a fixed cap are refused with an error. A request with mode
+// "metrics" is answered with the Prometheus metrics text, or an error when
+// MetricsRegistry is disabled.
+class CipherServer {
+public:
+    CipherServer(const CipherEngine& engine, const std::string& socketPath, size_t workers,
+                 size_t queueCapacity = 1024);
+    ~CipherServer();
+
+    CipherServer(const CipherServer&) = delete;
+    CipherServer& operator=(const CipherServer&) = delete;
+
+    // Binds the socket and serves until stop(); throws std::runtime_error if
+    // the socket cannot be created. The socket file is removed on return.
+    void run();
+    // Safe to call from a signal handler
+    void stop();
+
+private:
+    struct Connection {
+        int fd;
+        std::mutex writeMutex;
+        explicit Connection(int fd) : fd(fd) {}
+        ~Connection();
+    };
+
+    struct Work {
+        std::shared_ptr<Connection> connection;
+        FrameRequest request;
+    };
+
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<Connection> connection;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    const CipherEngine& engine;
+    std::string socketPath;
+    size_t workerCount;
+    BoundedQueue<Work> queue;
+    std::atomic<bool> stopping;
+    std::vector<Reader> readers;
+
+    void readLoop(std::shared_ptr<Connection> connection);
+    void workLoop();
+    void reapReaders(bool all);
+    static void respond(Connection& connection, const FrameResponse& response);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef FRAME_PROTOCOL_HPP
+#define FRAME_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "cipher_engine.hpp"
+
+// Wire format shared by fsct serve and fsct client. Every message is a frame:
+// a uint32 body length followed by the body. Integers are little-endian and
+// strings are a uint32 length followed by the bytes.
+//   request:  uint64 id, string cipher, string mode, string key, string text
+//   response: uint64 id, uint8 status (0 ok, 1 error), float64 score,
+//             string key, string text (the error message when status is 1)
+// Responses carry the id of their request and may arrive out of order when
+// a client has several requests in flight.
+struct FrameRequest {
+    uint64_t id = 0;
+    CipherJob job;
+};
+
+struct FrameResponse {
+    uint64_t id = 0;
+    CipherJobResult result;
+};
+
+// Larger frames are rejected before any of the body is read
+constexpr size_t MAX_FRAME_BYTES = 64u << 20;
+
+// Throw std::length_error when the body would exceed MAX_FRAME_BYTES
+std::string encodeRequest(const FrameRequest& request);
+std::string encodeResponse(const FrameResponse& response);
+// Throw std::invalid_argument on a malformed body
+FrameRequest decodeRequest(const std::string& body);
+FrameResponse decodeResponse(const std::string& body);
+
+// False on a clean end of stream before a frame starts. Throws
+// std::runtime_error on a truncated or oversized frame or a socket error.
+bool readFrame(int fd, std::string& body);
+// Throws std::runtime_error if the peer has gone away
+void writeFrame(int fd, const std::string& body);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef JSONL_HPP
+#define JSONL_HPP
+
+#include <map>
+#include <ostream>
+#include <string>
+
+// Minimal JSON Lines support for batch records: one flat object per line
+// whose values are strings, numbers, booleans or null. Numbers and booleans
+// are kept as their literal text; null fields are dropped.
+struct JsonValue {
+    std::string text;      // unescaped string contents, or the literal as written
+    bool literal = false;  // a number or boolean rather than a string
+};
+
+using JsonRecord = std::map<std::string, JsonValue>;
+
+// Throws std::invalid_argument describing the first syntax error
+JsonRecord parseJsonRecord(const std::string& line);
+
+// Quoted JSON string literal, with control characters escaped
+std::string jsonQuote(const std::string& text);
+
+// Builds one output record in insertion order
+class JsonRecordBuilder {
+public:
+    JsonRecordBuilder& add(const std::string& key, const std::string& value);
+    JsonRecordBuilder& add(const std::string& key, const char* value);
+    JsonRecordBuilder& add(const std::string& key, double value);  // non-finite values become null
+    JsonRecordBuilder& add(const std::string& key, size_t value);
+    JsonRecordBuilder& add(const std::string& key, bool value);
+    // Writes a parsed value back as it was read: quoted or literal
+    JsonRecordBuilder& add(const std::string& key, const JsonValue& value);
+
+    std::string str() const;
+
+private:
+    std::string body;
+
+    void addRaw(const std::string& key, const std::string& literal);
+};
+
+// Collects records in memory and hands them to the stream in large writes
+class JsonlWriter {
+public:
+    explicit JsonlWriter(std::ostream& out, size_t bufferBytes = 1 << 20);
+    ~JsonlWriter();
+
+    JsonlWriter(const JsonlWriter&) = delete;
+    JsonlWriter& operator=(const JsonlWriter&) = delete;
+
+    void write(const std::string& record);
+    void flush();
+
+private:
+    std::ostream& out;
+    std::string buffer;
+    size_t capacity;
+};
+
+#endif
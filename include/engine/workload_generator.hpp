@@ -0,0 +1,68 @@
+#ifndef WORKLOAD_GENERATOR_HPP
+#define WORKLOAD_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "cipher_engine.hpp"
+
+// Word-level Markov chain that produces English-looking plaintext
+class MarkovTextModel {
+public:
+    // First-order chain over the words of a corpus, in reading order
+    static MarkovTextModel fromCorpus(std::istream& in);
+    // A word list has no order to learn from, so the chain has one state and
+    // draws words weighted toward short ones, as running English does
+    static MarkovTextModel fromWords(const std::vector<std::string>& words);
+
+    // Sentences of whole words, at most length bytes unless the first word
+    // alone is longer
+    std::string generate(size_t length, std::mt19937_64& rng) const;
+
+    size_t vocabularySize() const;
+
+private:
+    std::vector<std::string> words;
+    std::vector<std::vector<uint32_t>> successors;  // per word; empty falls back to starts
+    std::vector<uint32_t> starts;                   // weighted by repetition
+
+    uint32_t nextWord(uint32_t current, bool restart, std::mt19937_64& rng) const;
+};
+
+struct WorkloadOptions {
+    std::string cipher = "vigenere";
+    size_t minKeyLength = 5;   // vigenere and playfair letters, transposition columns
+    size_t maxKeyLength = 12;
+    size_t totalBytes = 1 << 20;  // plaintext bytes, split evenly across messages
+    size_t count = 1000;
+    uint64_t seed = 42;
+};
+
+// Writes synthetic cipher jobs as JSON Lines that fsct batch accepts:
+//   {"id":"N","cipher":...,"mode":"crack","text":...,"expected_key":...,"plaintext":...}
+// Caesar, affine and vigenere records ask for a crack; transposition and
+// playfair cannot be cracked, so their records carry the key and ask for a
+// decrypt. The same options and seed give the same bytes on every platform:
+// std::mt19937_64 is fully specified and only its raw output is used.
+class WorkloadGenerator {
+public:
+    // Throws std::invalid_argument for an unknown cipher or bad key lengths
+    WorkloadGenerator(const CipherEngine& engine, const MarkovTextModel& model, const WorkloadOptions& options);
+
+    // Returns the number of records written
+    size_t run(std::ostream& out) const;
+
+private:
+    const CipherEngine& engine;
+    const MarkovTextModel& model;
+    WorkloadOptions options;
+
+    // Transposition keys are capped at textLength, which CipherEngine requires
+    std::string randomKey(std::mt19937_64& rng, size_t textLength) const;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Label name -> value; kept sorted so equal label sets name the same series
+using MetricLabels = std::map<std::string, std::string>;
+
+class Counter {
+public:
+    Counter() : value(0) {}
+    void add(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value;
+};
+
+class Gauge {
+public:
+    Gauge() : value(0) {}
+    void set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void add(int64_t amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+    // Raises the gauge to v if it is lower, for high-water marks
+    void observeMax(int64_t v);
+    int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value;
+};
+
+// Latency histogram in the style of HdrHistogram: values below 64 ns get a
+// bucket each, and every power of two above that is split into 32 linear
+// sub-buckets, so any recorded value is known to within about 3%. Recording
+// is a few atomic adds and never allocates.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void recordNanoseconds(uint64_t nanoseconds);
+
+    uint64_t count() const;
+    uint64_t sumNanoseconds() const;
+    uint64_t maxNanoseconds() const;
+    // Upper bound of the bucket holding the q-quantile (q in [0, 1]); 0 if empty
+    uint64_t quantileNanoseconds(double q) const;
+    // Recorded values no greater than bound
+    uint64_t countAtOrBelow(uint64_t bound) const;
+
+private:
+    static constexpr unsigned SUB_BUCKET_BITS = 6;
+    static constexpr size_t BUCKET_COUNT = (1u << SUB_BUCKET_BITS) + (64 - SUB_BUCKET_BITS) * (1u << (SUB_BUCKET_BITS - 1));
+
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+};
+
+// Records the lifetime of the scope into a histogram; a null histogram makes
+// it a no-op, which is how disabled metrics cost nothing but a branch.
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram* histogram)
+        : histogram(histogram), start(histogram ? std::chrono::steady_clock::now()
+                                                : std::chrono::steady_clock::time_point()) {}
+    ~ScopedLatency();
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Process-wide set of named metric series, exported in the Prometheus text
+// format. Metrics are off until setEnabled(true); instrumented code checks
+// enabled() first so a run without --metrics-out pays one relaxed load per
+// instrumented call. Series are created on first lookup and live for the
+// rest of the process, so callers may keep the returned references.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& global();
+
+    static bool enabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    // Exported in seconds; name should end in _seconds
+    LatencyHistogram& histogram(const std::string& name, const std::string& help,
+                                const MetricLabels& labels = {});
+
+    void writePrometheus(std::ostream& out) const;
+    std::string prometheusText() const;
+
+private:
+    template <typename T>
+    struct Family {
+        std::string help;
+        std::map<std::string, std::unique_ptr<T>> series;  // by rendered label set
+    };
+
+    static std::atomic<bool> enabledFlag;
+
+    mutable std::shared_mutex mutex;
+    std::map<std::string, Family<Counter>> counters;
+    std::map<std::string, Family<Gauge>> gauges;
+    std::map<std::string, Family<LatencyHistogram>> histograms;
+
+    template <typename T>
+    T& lookup(std::map<std::string, Family<T>>& families, const std::string& name, const std::string& help,
+              const MetricLabels& labels);
+};
+
+#endif
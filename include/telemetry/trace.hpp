@@ -0,0 +1,56 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Opt-in span tracing exported in the Chrome trace event format, which
+// chrome://tracing and Perfetto open directly. Each thread appends completed
+// spans to its own buffer, so recording never contends with other threads;
+// buffers outlive their threads and are gathered when the trace is written.
+// While tracing is off a TraceScope costs one relaxed load and a branch.
+class Tracer {
+public:
+    static bool enabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    // Starts recording; timestamps are relative to this call
+    static void start();
+    static void stop();
+
+    // Writes every span recorded so far as a Chrome trace JSON document
+    static void writeChromeTrace(std::ostream& out);
+
+    // name must outlive the tracer; string literals are the intended use
+    static void record(const char* name, std::chrono::steady_clock::time_point begin,
+                       std::chrono::steady_clock::time_point end);
+
+private:
+    static std::atomic<bool> enabledFlag;
+};
+
+// Records the enclosing scope as one span when tracing is on
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(Tracer::enabled() ? name : nullptr) {
+        if (this->name) begin = std::chrono::steady_clock::now();
+    }
+    ~TraceScope() {
+        if (name) Tracer::record(name, begin, std::chrono::steady_clock::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    std::chrono::steady_clock::time_point begin;
+};
+
+#define FSCT_TRACE_JOIN2(a, b) a##b
+#define FSCT_TRACE_JOIN(a, b) FSCT_TRACE_JOIN2(a, b)
+// Traces the rest of the enclosing block under a string-literal name
+#define FSCT_TRACE_SCOPE(name) TraceScope FSCT_TRACE_JOIN(fsctTraceScope, __LINE__)(name)
+
+#endif
@@ -0,0 +1,120 @@
+#include "../../include/analysis/aho_corasick.hpp"
+#include <stdexcept>
+
+AhoCorasick::AhoCorasick() : alphabetSize(1), built(false) {
+    symbolClass.fill(0);
+}
+
+AhoCorasick::AhoCorasick(const std::vector<std::string>& patterns) : AhoCorasick() {
+    for (const auto& pattern : patterns) {
+        addPattern(pattern);
+    }
+    build();
+}
+
+size_t AhoCorasick::addPattern(const std::string& pattern) {
+    patterns.push_back(pattern);
+    built = false;
+    return patterns.size() - 1;
+}
+
+size_t AhoCorasick::patternCount() const {
+    return patterns.size();
+}
+
+const std::string& AhoCorasick::getPattern(size_t id) const {
+    if (id >= patterns.size()) {
+        throw std::out_of_range("Pattern id out of range");
+    }
+    return patterns[id];
+}
+
+// Builds the trie over the compacted alphabet, then resolves failure links
+// breadth-first so every (state, symbol) pair has a direct transition and the
+// scan never follows a failure chain.
+void AhoCorasick::build() {
+    symbolClass.fill(0);
+    alphabetSize = 1;
+    for (const auto& pattern : patterns) {
+        for (unsigned char c : pattern) {
+            if (symbolClass[c] == 0) {
+                symbolClass[c] = static_cast<uint16_t>(alphabetSize++);
+            }
+        }
+    }
+
+    const uint32_t NONE = UINT32_MAX;
+    transitions.assign(alphabetSize, NONE);
+    std::vector<std::vector<uint32_t>> terminals(1);
+
+    for (size_t id = 0; id < patterns.size(); ++id) {
+        // An empty pattern has no end state to report from; it never matches
+        if (patterns[id].empty()) continue;
+
+        uint32_t state = 0;
+        for (unsigned char c : patterns[id]) {
+            uint32_t& next = transitions[state * alphabetSize + symbolClass[c]];
+            if (next == NONE) {
+                next = static_cast<uint32_t>(terminals.size());
+                terminals.emplace_back();
+                transitions.resize(transitions.size() + alphabetSize, NONE);
+            }
+            state = transitions[state * alphabetSize + symbolClass[c]];
+        }
+        terminals[state].push_back(static_cast<uint32_t>(id));
+    }
+
+    size_t states = terminals.size();
+    std::vector<uint32_t> fail(states, 0);
+    outputLink.assign(states, 0);
+
+    std::vector<uint32_t> queue;
+    queue.reserve(states);
+    for (size_t a = 0; a < alphabetSize; ++a) {
+        uint32_t& next = transitions[a];
+        if (next == NONE) {
+            next = 0;
+        } else {
+            queue.push_back(next);
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t state = queue[head];
+        uint32_t failState = fail[state];
+        outputLink[state] = terminals[failState].empty() ? outputLink[failState] : failState;
+
+        for (size_t a = 0; a < alphabetSize; ++a) {
+            uint32_t& next = transitions[state * alphabetSize + a];
+            uint32_t fallback = transitions[failState * alphabetSize + a];
+            if (next == NONE) {
+                next = fallback;
+            } else {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    outputOffsets.assign(states + 1, 0);
+    outputIds.clear();
+    for (size_t s = 0; s < states; ++s) {
+        outputOffsets[s] = static_cast<uint32_t>(outputIds.size());
+        outputIds.insert(outputIds.end(), terminals[s].begin(), terminals[s].end());
+    }
+    outputOffsets[states] = static_cast<uint32_t>(outputIds.size());
+
+    built = true;
+}
+
+std::vector<std::vector<size_t>> AhoCorasick::findAll(const std::string& text) const {
+    if (!built) {
+        throw std::logic_error("AhoCorasick::build() must be called before searching");
+    }
+
+    std::vector<std::vector<size_t>> occurrences(patterns.size());
+    scan(text.data(), text.length(), [&occurrences](size_t id, size_t start) {
+        occurrences[id].push_back(start);
+    });
+    return occurrences;
+}
@@ -0,0 +1,289 @@
+#include "../../include/analysis/crib_dragger.hpp"
+#include "../../include/analysis/histogram.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// English letter frequencies, used to judge whether a key looks like text
+constexpr double ENGLISH_FREQUENCIES[26] = {
+    0.08167, 0.01492, 0.02782, 0.04253, 0.12702, 0.02228, 0.02015, 0.06094, 0.06966,
+    0.00153, 0.00772, 0.04025, 0.02406, 0.06749, 0.07507, 0.01929, 0.00095, 0.05987,
+    0.06327, 0.09056, 0.02758, 0.00978, 0.02360, 0.00150, 0.01974, 0.00074
+};
+
+constexpr double PERIODICITY_WEIGHT = 0.6;
+constexpr double WORD_WEIGHT = 0.4;
+// Only this many times topN cheap-scored hits get the dictionary pass
+constexpr size_t REFINE_FACTOR = 8;
+constexpr size_t MIN_REFINE = 64;
+constexpr size_t MIN_DICTIONARY_WORD = 3;
+
+struct LetterLikelihood {
+    double logFrequency[26];
+    double randomMean;   // mean log-frequency of uniformly random letters
+    double englishMean;  // mean log-frequency of English letters
+    LetterLikelihood() : randomMean(0.0), englishMean(0.0) {
+        for (int i = 0; i < 26; ++i) {
+            logFrequency[i] = std::log(ENGLISH_FREQUENCIES[i]);
+            randomMean += logFrequency[i] / 26.0;
+            englishMean += ENGLISH_FREQUENCIES[i] * logFrequency[i];
+        }
+    }
+};
+
+const LetterLikelihood LIKELIHOOD;
+
+double letterScore(const uint8_t* shifts, size_t length) {
+    if (length == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < length; ++i) {
+        sum += LIKELIHOOD.logFrequency[shifts[i]];
+    }
+    double scaled = (sum / length - LIKELIHOOD.randomMean) / (LIKELIHOOD.englishMean - LIKELIHOOD.randomMean);
+    return std::max(0.0, std::min(1.0, scaled));
+}
+
+size_t countEqual(const uint8_t* a, const uint8_t* b, size_t length) {
+    size_t matches = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+        matches += __builtin_popcount(mask);
+    }
+#endif
+
+    for (; i < length; ++i) {
+        matches += (a[i] == b[i]);
+    }
+    return matches;
+}
+
+// Best self-repeat distance p <= length / 2. The score is the number of
+// positions confirmed by a repeat over the fragment length, so a fragment of
+// a key with period p that is fully consistent scores 1 - p / length.
+size_t bestPeriod(const uint8_t* shifts, size_t length, double& score) {
+    size_t best = 0;
+    size_t bestAgree = 0;
+    for (size_t p = 1; p <= length / 2; ++p) {
+        size_t agree = countEqual(shifts, shifts + p, length - p);
+        // Only fully consistent periods describe a repeating key
+        if (agree == length - p && agree > bestAgree) {
+            best = p;
+            bestAgree = agree;
+        }
+    }
+    score = length ? static_cast<double>(bestAgree) / length : 0.0;
+    return best;
+}
+
+std::string fragmentString(const uint8_t* shifts, size_t length) {
+    std::string fragment(length, 'a');
+    for (size_t i = 0; i < length; ++i) {
+        fragment[i] = static_cast<char>('a' + shifts[i]);
+    }
+    return fragment;
+}
+
+bool rankedBefore(const CribHit& a, const CribHit& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.position < b.position;
+}
+
+// Keeps the best `capacity` hits seen so far; worst hit on top
+class TopHits {
+public:
+    explicit TopHits(size_t capacity) : capacity(capacity), heap(rankedBefore) {}
+
+    bool wouldKeep(double score) const {
+        return capacity == 0 || heap.size() < capacity || score > heap.top().score;
+    }
+
+    void push(CribHit hit) {
+        heap.push(std::move(hit));
+        if (capacity && heap.size() > capacity) heap.pop();
+    }
+
+    std::vector<CribHit> take() {
+        std::vector<CribHit> hits;
+        hits.reserve(heap.size());
+        while (!heap.empty()) {
+            hits.push_back(heap.top());
+            heap.pop();
+        }
+        return hits;
+    }
+
+private:
+    size_t capacity;
+    std::priority_queue<CribHit, std::vector<CribHit>, std::function<bool(const CribHit&, const CribHit&)>> heap;
+};
+}
+
+CribDragger::CribDragger(const std::string& ciphertext, Dictionary* dict) : dictionary(dict) {
+    letters.reserve(ciphertext.length());
+    letterOffsets.reserve(ciphertext.length());
+    for (size_t i = 0; i < ciphertext.length(); ++i) {
+        uint8_t index = HistogramKernel::letterIndex(static_cast<unsigned char>(ciphertext[i]));
+        if (index != HistogramKernel::NOT_A_LETTER) {
+            letters.push_back(index);
+            letterOffsets.push_back(i);
+        }
+    }
+}
+
+// Letters are kept as 0-25, so c - p lies in [-25, 25]; negative lanes get 26 added.
+void CribDragger::impliedShifts(const uint8_t* cipher, const uint8_t* plain, size_t length, uint8_t* shifts) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i modulus = _mm_set1_epi8(26);
+    for (; i + 16 <= length; i += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cipher + i));
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(plain + i));
+        __m128i d = _mm_sub_epi8(c, p);
+        __m128i wrap = _mm_and_si128(_mm_cmpgt_epi8(zero, d), modulus);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(shifts + i), _mm_add_epi8(d, wrap));
+    }
+#endif
+
+    for (; i < length; ++i) {
+        int d = static_cast<int>(cipher[i]) - plain[i];
+        shifts[i] = static_cast<uint8_t>(d < 0 ? d + 26 : d);
+    }
+}
+
+std::vector<uint8_t> CribDragger::cribLetters(const std::string& crib) {
+    std::vector<uint8_t> plain;
+    for (char c : crib) {
+        uint8_t index = HistogramKernel::letterIndex(static_cast<unsigned char>(c));
+        if (index != HistogramKernel::NOT_A_LETTER) plain.push_back(index);
+    }
+    if (plain.empty()) {
+        throw std::invalid_argument("Crib must contain at least one letter");
+    }
+    return plain;
+}
+
+// Cheap scores for every offset, then the dictionary pass on a shortlist only
+std::vector<CribHit> CribDragger::dragVigenere(const std::string& crib, size_t topN) const {
+    std::vector<uint8_t> plain = cribLetters(crib);
+    size_t length = plain.size();
+    if (length > letters.size()) return {};
+
+    size_t shortlist = topN == 0 ? 0 : std::max(topN * REFINE_FACTOR, MIN_REFINE);
+    TopHits best(shortlist);
+    std::vector<uint8_t> shifts(length);
+
+    for (size_t pos = 0; pos + length <= letters.size(); ++pos) {
+        impliedShifts(letters.data() + pos, plain.data(), length, shifts.data());
+
+        double periodicity = 0.0;
+        size_t period = bestPeriod(shifts.data(), length, periodicity);
+        const uint8_t* unit = shifts.data();
+        size_t unitLength = period ? period : length;
+        double words = letterScore(unit, unitLength);
+        double score = PERIODICITY_WEIGHT * periodicity + WORD_WEIGHT * words;
+        if (!best.wouldKeep(score)) continue;
+
+        CribHit hit;
+        hit.position = pos;
+        hit.textOffset = letterOffsets[pos];
+        hit.keyFragment = fragmentString(shifts.data(), length);
+        hit.period = period;
+        if (period) {
+            // Rotate so key[0] lines up with the first letter of the text
+            hit.key.assign(period, 'a');
+            for (size_t j = 0; j < period; ++j) {
+                hit.key[(pos + j) % period] = hit.keyFragment[j];
+            }
+        }
+        hit.periodicityScore = periodicity;
+        hit.wordScore = words;
+        hit.score = score;
+        best.push(std::move(hit));
+    }
+
+    std::vector<CribHit> hits = best.take();
+    refineAndRank(hits, topN);
+    return hits;
+}
+
+// A Caesar key is one shift, so a placement is as good as the share of its
+// fragment that agrees with the most common shift.
+std::vector<CribHit> CribDragger::dragCaesar(const std::string& crib, size_t topN) const {
+    std::vector<uint8_t> plain = cribLetters(crib);
+    size_t length = plain.size();
+    if (length > letters.size()) return {};
+
+    TopHits best(topN);
+    std::vector<uint8_t> shifts(length);
+
+    for (size_t pos = 0; pos + length <= letters.size(); ++pos) {
+        impliedShifts(letters.data() + pos, plain.data(), length, shifts.data());
+
+        std::array<size_t, 26> votes{};
+        for (uint8_t s : shifts) votes[s]++;
+        size_t shift = std::max_element(votes.begin(), votes.end()) - votes.begin();
+        double agreement = static_cast<double>(votes[shift]) / length;
+        if (!best.wouldKeep(agreement)) continue;
+
+        CribHit hit;
+        hit.position = pos;
+        hit.textOffset = letterOffsets[pos];
+        hit.keyFragment = fragmentString(shifts.data(), length);
+        hit.period = 1;
+        hit.key = std::string(1, static_cast<char>('a' + shift));
+        hit.periodicityScore = agreement;
+        hit.wordScore = 0.0;
+        hit.score = agreement;
+        best.push(std::move(hit));
+    }
+
+    std::vector<CribHit> hits = best.take();
+    std::sort(hits.begin(), hits.end(), rankedBefore);
+    return hits;
+}
+
+// Longest dictionary word inside unit (wrapping around when the unit is a
+// key period) as a share of the unit length.
+double CribDragger::dictionaryCoverage(const std::string& unit, bool cyclic) const {
+    if (!dictionary || unit.length() < MIN_DICTIONARY_WORD) return 0.0;
+    std::string haystack = cyclic ? unit + unit : unit;
+    size_t longest = 0;
+
+    for (size_t start = 0; start < unit.length(); ++start) {
+        size_t maxLength = std::min(unit.length(), haystack.length() - start);
+        for (size_t len = maxLength; len >= MIN_DICTIONARY_WORD && len > longest; --len) {
+            if (dictionary->isInDictionary(haystack.substr(start, len))) {
+                longest = len;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(longest) / unit.length();
+}
+
+void CribDragger::refineAndRank(std::vector<CribHit>& hits, size_t topN) const {
+    for (auto& hit : hits) {
+        bool cyclic = hit.period != 0;
+        const std::string& unit = cyclic ? hit.key : hit.keyFragment;
+        hit.wordScore = std::max(hit.wordScore, dictionaryCoverage(unit, cyclic));
+        hit.score = PERIODICITY_WEIGHT * hit.periodicityScore + WORD_WEIGHT * hit.wordScore;
+    }
+
+    std::sort(hits.begin(), hits.end(), rankedBefore);
+    if (topN && hits.size() > topN) hits.resize(topN);
+}
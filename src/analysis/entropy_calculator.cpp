@@ -1,4 +1,6 @@
 #include "../../include/analysis/entropy_calculator.hpp"
+#include "../../include/analysis/histogram.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <cmath>
 #include <algorithm>
 #include <sstream>
@@ -16,99 +18,172 @@ EntropyCalculator::EntropyCalculator(const std::string& referenceText) {
 }
 
 EntropyMetrics EntropyCalculator::calculateFullMetrics(const std::string& text) const {
+    FSCT_TRACE_SCOPE("EntropyCalculator::calculateFullMetrics");
+    EntropyDetails details;
+    EntropySummary summary = calculateMetrics(text, METRIC_ALL, &details);
+
     EntropyMetrics metrics;
-    metrics.shannonEntropy = calculateShannon(text);
-    metrics.normalizedEntropy = calculateNormalizedEntropy(text);
-    metrics.conditionalEntropy = calculateConditionalEntropy(text, text);
-    metrics.jointEntropy = calculateJointEntropy(text.substr(0, text.length()/2), 
-                                               text.substr(text.length()/2));
-    metrics.mutualInformation = calculateMutualInformation(text.substr(0, text.length()/2), 
-                                                         text.substr(text.length()/2));
-    metrics.relativeEntropy = calculateRelativeEntropy(text, text);
-    metrics.characterProbabilities = calculateProbabilities(text);
-    metrics.ngramEntropies = calculateNGramEntropies(text, 3);
+    metrics.shannonEntropy = summary.shannonEntropy;
+    metrics.normalizedEntropy = summary.normalizedEntropy;
+    metrics.conditionalEntropy = summary.conditionalEntropy;
+    metrics.jointEntropy = summary.jointEntropy;
+    metrics.mutualInformation = summary.mutualInformation;
+    metrics.relativeEntropy = summary.relativeEntropy;
+    metrics.characterProbabilities = std::move(details.characterProbabilities);
+    metrics.ngramEntropies = std::move(details.ngramEntropies);
     
     return metrics;
 }
 
-double EntropyCalculator::calculateShannon(const std::string& text) const {
-    auto probabilities = calculateProbabilities(text);
-    double entropy = 0.0;
-    
-    for (const auto& [symbol, prob] : probabilities) {
-        if (prob > 0) {
-            entropy -= prob * calculateLog2(prob);
+// Compute only the requested metrics. The whole-text histogram is built once
+// and shared; joint entropy and mutual information read the two halves of the
+// text in place instead of copying them out.
+EntropySummary EntropyCalculator::calculateMetrics(
+    const std::string& text, unsigned requested, EntropyDetails* details) const {
+    EntropySummary summary = {};
+    if (!details) {
+        requested &= ~(METRIC_CHARACTER_PROBABILITIES | METRIC_NGRAM_ENTROPIES);
+    }
+    summary.computed = requested;
+
+    const unsigned needsTextCounts = METRIC_SHANNON | METRIC_NORMALIZED | METRIC_CONDITIONAL |
+        METRIC_RELATIVE | METRIC_CHARACTER_PROBABILITIES;
+    ByteCounts counts{};
+    if (requested & needsTextCounts) {
+        countBytes(text.data(), text.length(), counts);
+    }
+
+    if (requested & (METRIC_SHANNON | METRIC_NORMALIZED)) {
+        summary.shannonEntropy = entropyFromCounts(counts, text.length());
+        if (requested & METRIC_NORMALIZED) {
+            double maxEntropy = calculateLog2(static_cast<double>(text.length()));
+            summary.normalizedEntropy = maxEntropy > 0 ? summary.shannonEntropy / maxEntropy : 0.0;
+        }
+        if (!(requested & METRIC_SHANNON)) {
+            summary.shannonEntropy = 0.0;
         }
     }
-    
-    return entropy;
+
+    if (requested & METRIC_CONDITIONAL) {
+        summary.conditionalEntropy = conditionalEntropyWithCounts(text, text, counts);
+    }
+
+    if (requested & (METRIC_JOINT | METRIC_MUTUAL_INFORMATION)) {
+        size_t half = text.length() / 2;
+        const char* first = text.data();
+        const char* second = text.data() + half;
+        size_t firstLength = half;
+        size_t secondLength = text.length() - half;
+
+        size_t pairs = std::min(firstLength, secondLength);
+
+        JointCounts joint(256 * 256, 0);
+        fillJointCounts(first, second, pairs, joint);
+        double jointEntropy = jointEntropyFromCounts(joint, pairs);
+        if (requested & METRIC_JOINT) {
+            summary.jointEntropy = jointEntropy;
+        }
+        if (requested & METRIC_MUTUAL_INFORMATION) {
+            ByteCounts rows{}, columns{};
+            marginalsFromJoint(joint, rows, columns);
+            summary.mutualInformation = entropyFromCounts(rows, pairs) +
+                entropyFromCounts(columns, pairs) - jointEntropy;
+        }
+    }
+
+    if (requested & METRIC_RELATIVE) {
+        summary.relativeEntropy = relativeEntropyFromCounts(counts, text.length(), counts, text.length());
+    }
+
+    if (requested & METRIC_CHARACTER_PROBABILITIES) {
+        details->characterProbabilities.clear();
+        for (size_t b = 0; b < counts.size(); ++b) {
+            if (counts[b] > 0) {
+                details->characterProbabilities[static_cast<char>(b)] =
+                    static_cast<double>(counts[b]) / text.length();
+            }
+        }
+    }
+
+    if (requested & METRIC_NGRAM_ENTROPIES) {
+        details->ngramEntropies = calculateNGramEntropies(text, 3);
+    }
+
+    return summary;
+}
+
+double EntropyCalculator::calculateShannon(const std::string& text) const {
+    ByteCounts counts{};
+    countBytes(text.data(), text.length(), counts);
+    return entropyFromCounts(counts, text.length());
 }
 
 double EntropyCalculator::calculateNormalizedEntropy(const std::string& text) const {
     double maxEntropy = calculateLog2(static_cast<double>(text.length()));
+    if (maxEntropy <= 0) return 0.0;
     return calculateShannon(text) / maxEntropy;
 }
 
 double EntropyCalculator::calculateConditionalEntropy(
     const std::string& text, const std::string& condition) const {
-    auto jointProbs = calculateNGramProbabilities(text + condition, 2);
-    auto conditionProbs = calculateProbabilities(condition);
-    double conditionalEntropy = 0.0;
-    
-    for (const auto& [pair, jointProb] : jointProbs) {
-        if (pair.length() >= 2) {
-            char conditionChar = pair[1];
-            double condProb = conditionProbs[conditionChar];
-            if (condProb > 0 && jointProb > 0) {
-                conditionalEntropy -= jointProb * calculateLog2(jointProb / condProb);
-            }
-        }
-    }
-    
-    return conditionalEntropy;
+    ByteCounts conditionCounts{};
+    countBytes(condition.data(), condition.length(), conditionCounts);
+    return conditionalEntropyWithCounts(text, condition, conditionCounts);
 }
 
 double EntropyCalculator::calculateJointEntropy(
     const std::string& text1, const std::string& text2) const {
-    std::map<std::pair<char, char>, double> jointDist;
-    size_t minLength = std::min(text1.length(), text2.length());
-    
-    for (size_t i = 0; i < minLength; ++i) {
-        jointDist[{text1[i], text2[i]}] += 1.0 / minLength;
-    }
-    
-    double jointEntropy = 0.0;
-    for (const auto& [pair, prob] : jointDist) {
-        if (prob > 0) {
-            jointEntropy -= prob * calculateLog2(prob);
-        }
-    }
-    
-    return jointEntropy;
+    return jointEntropyOfRanges(text1.data(), text2.data(),
+                                std::min(text1.length(), text2.length()));
 }
 
+// I(X;Y) = H(X) + H(Y) - H(X,Y), with all three read off one joint matrix
 double EntropyCalculator::calculateMutualInformation(
     const std::string& text1, const std::string& text2) const {
-    double entropy1 = calculateShannon(text1);
-    double entropy2 = calculateShannon(text2);
-    double jointEntropy = calculateJointEntropy(text1, text2);
-    return entropy1 + entropy2 - jointEntropy;
+    size_t length = std::min(text1.length(), text2.length());
+    if (length == 0) return 0.0;
+
+    JointCounts joint(256 * 256, 0);
+    fillJointCounts(text1.data(), text2.data(), length, joint);
+
+    ByteCounts rows{}, columns{};
+
+    marginalsFromJoint(joint, rows, columns);
+
+    return entropyFromCounts(rows, length) + entropyFromCounts(columns, length) -
+        jointEntropyFromCounts(joint, length);
 }
 
 double EntropyCalculator::calculateRelativeEntropy(
     const std::string& text, const std::string& referenceText) const {
-    auto probsP = calculateProbabilities(text);
-    auto probsQ = calculateProbabilities(referenceText);
-    double relativeEntropy = 0.0;
-    
-    for (const auto& [symbol, probP] : probsP) {
-        double probQ = probsQ[symbol];
-        if (probP > 0 && probQ > 0) {
-            relativeEntropy += probP * calculateLog2(probP / probQ);
-        }
+    ByteCounts countsP{}, countsQ{};
+    countBytes(text.data(), text.length(), countsP);
+    countBytes(referenceText.data(), referenceText.length(), countsQ);
+    return relativeEntropyFromCounts(countsP, text.length(), countsQ, referenceText.length());
+}
+
+std::vector<LaggedEntropy> EntropyCalculator::calculateLaggedEntropies(
+    const std::string& text, size_t maxLag) const {
+    std::vector<LaggedEntropy> results;
+    JointCounts joint(256 * 256);
+
+    for (size_t lag = 1; lag <= maxLag && lag < text.length(); ++lag) {
+        size_t pairs = text.length() - lag;
+        std::fill(joint.begin(), joint.end(), 0);
+        fillJointCounts(text.data(), text.data() + lag, pairs, joint);
+
+        ByteCounts rows{}, columns{};
+
+        marginalsFromJoint(joint, rows, columns);
+
+        double jointEntropy = jointEntropyFromCounts(joint, pairs);
+        double firstEntropy = entropyFromCounts(rows, pairs);
+        double secondEntropy = entropyFromCounts(columns, pairs);
+        results.push_back({lag, jointEntropy, jointEntropy - firstEntropy,
+                           firstEntropy + secondEntropy - jointEntropy});
     }
-    
-    return relativeEntropy;
+
+    return results;
 }
 
 std::map<std::string, double> EntropyCalculator::calculateNGramEntropies(
@@ -176,10 +251,14 @@ std::vector<double> EntropyCalculator::calculateEntropySpectrum(
 std::map<char, double> EntropyCalculator::calculateProbabilities(
     const std::string& text) const {
     std::map<char, double> probabilities;
+    ByteCounts counts{};
+    countBytes(text.data(), text.length(), counts);
     double total = text.length();
     
-    for (char c : text) {
-        probabilities[c] += 1.0 / total;
+    for (size_t b = 0; b < counts.size(); ++b) {
+        if (counts[b] > 0) {
+            probabilities[static_cast<char>(b)] = counts[b] / total;
+        }
     }
     
     return probabilities;
@@ -216,3 +295,120 @@ std::vector<std::string> EntropyCalculator::extractNGrams(
 void EntropyCalculator::initializeReferenceDistribution(const std::string& text) {
     referenceDistribution = calculateProbabilities(text);
 }
+
+void EntropyCalculator::countBytes(const char* data, size_t length, ByteCounts& counts) {
+    HistogramKernel::countBytes(data, length, counts);
+}
+
+double EntropyCalculator::entropyFromCounts(const ByteCounts& counts, size_t total) const {
+    if (total == 0) return 0.0;
+    double entropy = 0.0;
+    for (uint64_t count : counts) {
+        if (count > 0) {
+            double prob = static_cast<double>(count) / total;
+            entropy -= prob * calculateLog2(prob);
+        }
+    }
+    return entropy;
+}
+
+double EntropyCalculator::relativeEntropyFromCounts(
+    const ByteCounts& countsP, size_t totalP, const ByteCounts& countsQ, size_t totalQ) const {
+    if (totalP == 0 || totalQ == 0) return 0.0;
+    double relativeEntropy = 0.0;
+    for (size_t b = 0; b < countsP.size(); ++b) {
+        if (countsP[b] > 0 && countsQ[b] > 0) {
+            double probP = static_cast<double>(countsP[b]) / totalP;
+            double probQ = static_cast<double>(countsQ[b]) / totalQ;
+            relativeEntropy += probP * calculateLog2(probP / probQ);
+        }
+    }
+    return relativeEntropy;
+}
+
+// Pair indices are computed a block at a time so the index pass vectorizes;
+// the scatter into the dense matrix is then a plain increment loop.
+void EntropyCalculator::fillJointCounts(
+    const char* first, const char* second, size_t length, JointCounts& joint) {
+    const unsigned char* a = reinterpret_cast<const unsigned char*>(first);
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(second);
+    constexpr size_t BLOCK = 256;
+    uint16_t indices[BLOCK];
+
+    for (size_t start = 0; start < length; start += BLOCK) {
+        size_t count = std::min(BLOCK, length - start);
+        for (size_t i = 0; i < count; ++i) {
+            indices[i] = static_cast<uint16_t>((a[start + i] << 8) | b[start + i]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            joint[indices[i]]++;
+        }
+    }
+}
+
+void EntropyCalculator::marginalsFromJoint(
+    const JointCounts& joint, ByteCounts& rows, ByteCounts& columns) {
+    for (size_t x = 0; x < 256; ++x) {
+        for (size_t y = 0; y < 256; ++y) {
+            uint32_t count = joint[x * 256 + y];
+            rows[x] += count;
+            columns[y] += count;
+        }
+    }
+}
+
+double EntropyCalculator::jointEntropyFromCounts(const JointCounts& joint, size_t total) const {
+    if (total == 0) return 0.0;
+    double entropy = 0.0;
+    for (uint32_t count : joint) {
+        if (count > 0) {
+            double prob = static_cast<double>(count) / total;
+            entropy -= prob * calculateLog2(prob);
+        }
+    }
+    return entropy;
+}
+
+double EntropyCalculator::jointEntropyOfRanges(
+    const char* first, const char* second, size_t length) const {
+    if (length == 0) return 0.0;
+    JointCounts joint(256 * 256, 0);
+    fillJointCounts(first, second, length, joint);
+    return jointEntropyFromCounts(joint, length);
+}
+
+// Bigram statistics over text followed by condition, weighted against the
+// symbol distribution of condition. The bigrams of the concatenation are
+// counted straight from the two buffers plus the one pair that spans them.
+double EntropyCalculator::conditionalEntropyWithCounts(
+    const std::string& text, const std::string& condition, const ByteCounts& conditionCounts) const {
+    size_t combinedLength = text.length() + condition.length();
+    if (combinedLength < 2 || condition.empty()) return 0.0;
+
+    JointCounts joint(256 * 256, 0);
+    if (text.length() > 1) {
+        fillJointCounts(text.data(), text.data() + 1, text.length() - 1, joint);
+    }
+    if (!text.empty()) {
+        joint[(static_cast<unsigned char>(text.back()) << 8) |
+              static_cast<unsigned char>(condition.front())]++;
+    }
+    if (condition.length() > 1) {
+        fillJointCounts(condition.data(), condition.data() + 1, condition.length() - 1, joint);
+    }
+
+    double pairs = static_cast<double>(combinedLength - 1);
+    double conditionTotal = static_cast<double>(condition.length());
+    double conditionalEntropy = 0.0;
+
+    for (size_t index = 0; index < joint.size(); ++index) {
+        if (joint[index] == 0) continue;
+        uint64_t conditionCount = conditionCounts[index & 0xFF];
+        if (conditionCount == 0) continue;
+        double jointProb = joint[index] / pairs;
+        double condProb = conditionCount / conditionTotal;
+        conditionalEntropy -= jointProb * calculateLog2(jointProb / condProb);
+    }
+
+    return conditionalEntropy;
+}
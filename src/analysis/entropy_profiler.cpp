@@ -0,0 +1,202 @@
+#include "../../include/analysis/entropy_profiler.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+constexpr size_t READ_BLOCK_SIZE = 1 << 20;
+
+inline int letterIndex(unsigned char b) {
+    unsigned folded = static_cast<unsigned>(b | 0x20) - 'a';
+    return folded < 26 ? static_cast<int>(folded) : -1;
+}
+
+// Goes through an integer of the same width so the bytes come out least
+// significant first whatever the host byte order
+template <typename T>
+void writeLittleEndian(std::ostream& out, T value) {
+    using Bits = typename std::conditional<sizeof(T) == 8, uint64_t, uint32_t>::type;
+    static_assert(sizeof(T) == sizeof(Bits), "only 4- and 8-byte values are written");
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    unsigned char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bytes[i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+    out.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+}
+
+EntropyProfiler::EntropyProfiler(size_t windowSize, size_t stepSize)
+    : windowSize(windowSize), stepSize(stepSize), ring(windowSize) {
+    if (windowSize == 0 || stepSize == 0) {
+        throw std::invalid_argument("Window and step sizes must be positive");
+    }
+    if (windowSize > UINT32_MAX) {
+        throw std::invalid_argument("Window size too large");
+    }
+
+    countLog2Table.resize(windowSize + 1);
+    countLog2Table[0] = 0.0;
+    for (size_t c = 1; c <= windowSize; ++c) {
+        countLog2Table[c] = c * std::log2(static_cast<double>(c));
+    }
+    reset();
+}
+
+size_t EntropyProfiler::profileStream(
+    std::istream& in, const std::function<void(const WindowProfile&)>& emit) {
+    reset();
+    std::vector<char> block(READ_BLOCK_SIZE);
+    uint64_t position = 0;
+    size_t windows = 0;
+    size_t slot = 0;
+    size_t untilEmit = windowSize;  // bytes left before the next window closes
+    bool ringFull = false;
+
+    while (in) {
+        in.read(block.data(), block.size());
+        std::streamsize got = in.gcount();
+        if (got <= 0) break;
+
+        for (std::streamsize i = 0; i < got; ++i) {
+            unsigned char b = static_cast<unsigned char>(block[i]);
+            if (ringFull) {
+                removeByte(ring[slot]);
+            }
+            ring[slot] = b;
+            addByte(b);
+            ++position;
+
+            if (++slot == windowSize) {
+                slot = 0;
+                ringFull = true;
+            }
+
+            if (--untilEmit == 0) {
+                emit(snapshot(position - windowSize, static_cast<uint32_t>(windowSize)));
+                ++windows;
+                untilEmit = stepSize;
+            }
+        }
+    }
+
+    if (windows == 0 && position > 0) {
+        emit(snapshot(0, static_cast<uint32_t>(position)));
+        ++windows;
+    } else if (windows > 0 && untilEmit != stepSize) {
+        // The steps stopped short of the last byte; close one more window there
+        emit(snapshot(position - windowSize, static_cast<uint32_t>(windowSize)));
+        ++windows;
+    }
+    return windows;
+}
+
+size_t EntropyProfiler::profileFile(
+    const std::string& path, const std::function<void(const WindowProfile&)>& emit) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    return profileStream(file, emit);
+}
+
+void EntropyProfiler::writeCsvHeader(std::ostream& out) {
+    out << "offset,length,byte_entropy,letter_count,letter_entropy,ioc\n";
+}
+
+void EntropyProfiler::writeCsvRow(std::ostream& out, const WindowProfile& profile) {
+    out << profile.offset << ',' << profile.length << ','
+        << std::fixed << std::setprecision(6) << profile.byteEntropy << ','
+        << profile.letterCount << ',' << profile.letterEntropy << ','
+        << profile.indexOfCoincidence << '\n';
+}
+
+// Binary layout: "FSCTENT1", u64 window, u64 step, then one 32-byte record per
+// window (u64 offset, u32 length, u32 letterCount, f64 byteEntropy, f32
+// letterEntropy, f32 ioc), all little-endian.
+void EntropyProfiler::writeBinaryHeader(std::ostream& out, size_t windowSize, size_t stepSize) {
+    out.write("FSCTENT1", 8);
+    writeLittleEndian<uint64_t>(out, windowSize);
+    writeLittleEndian<uint64_t>(out, stepSize);
+}
+
+void EntropyProfiler::writeBinaryRecord(std::ostream& out, const WindowProfile& profile) {
+    writeLittleEndian<uint64_t>(out, profile.offset);
+    writeLittleEndian<uint32_t>(out, profile.length);
+    writeLittleEndian<uint32_t>(out, profile.letterCount);
+    writeLittleEndian<double>(out, profile.byteEntropy);
+    writeLittleEndian<float>(out, static_cast<float>(profile.letterEntropy));
+    writeLittleEndian<float>(out, static_cast<float>(profile.indexOfCoincidence));
+}
+
+size_t EntropyProfiler::getWindowSize() const {
+    return windowSize;
+}
+
+size_t EntropyProfiler::getStepSize() const {
+    return stepSize;
+}
+
+void EntropyProfiler::reset() {
+    byteCounts.fill(0);
+    letterCounts.fill(0);
+    letterTotal = 0;
+}
+
+void EntropyProfiler::addByte(unsigned char b) {
+    byteCounts[b]++;
+    int letter = letterIndex(b);
+    if (letter >= 0) {
+        letterCounts[letter]++;
+        letterTotal++;
+    }
+}
+
+void EntropyProfiler::removeByte(unsigned char b) {
+    byteCounts[b]--;
+    int letter = letterIndex(b);
+    if (letter >= 0) {
+        letterCounts[letter]--;
+        letterTotal--;
+    }
+}
+
+// H = log2(N) - (1/N) * sum(c * log2(c)), evaluated from the live histograms
+WindowProfile EntropyProfiler::snapshot(uint64_t offset, uint32_t length) const {
+    WindowProfile profile;
+    profile.offset = offset;
+    profile.length = length;
+    profile.letterCount = letterTotal;
+
+    double byteSum = 0.0;
+    for (uint32_t count : byteCounts) {
+        byteSum += countLog2Table[count];
+    }
+    profile.byteEntropy = std::log2(static_cast<double>(length)) - byteSum / length;
+
+    double letterSum = 0.0;
+    uint64_t pairs = 0;
+    for (uint32_t count : letterCounts) {
+        letterSum += countLog2Table[count];
+        pairs += static_cast<uint64_t>(count) * (count > 0 ? count - 1 : 0);
+    }
+
+    if (letterTotal > 0) {
+        profile.letterEntropy = std::log2(static_cast<double>(letterTotal)) - letterSum / letterTotal;
+    } else {
+        profile.letterEntropy = 0.0;
+    }
+
+    if (letterTotal > 1) {
+        profile.indexOfCoincidence = static_cast<double>(pairs) /
+            (static_cast<double>(letterTotal) * (letterTotal - 1));
+    } else {
+        profile.indexOfCoincidence = 0.0;
+    }
+
+    return profile;
+}
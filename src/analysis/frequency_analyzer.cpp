@@ -1,10 +1,17 @@
 #include "../../include/analysis/frequency_analyzer.hpp"
 #include "../../include/analysis/entropy_calculator.hpp"
+#include "../../include/analysis/histogram.hpp"
+#include "../../include/concurrency/thread_pool.hpp"
 #include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <stdexcept>
 #include <sstream>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Initialize English letter frequencies, found them somewhere on the internet
 const std::array<double, 26> FrequencyAnalyzer::ENGLISH_FREQUENCIES = {
@@ -16,41 +23,214 @@ const std::array<double, 26> FrequencyAnalyzer::ENGLISH_FREQUENCIES = {
     0.00074  // Z
 };
 
+size_t NGramTable::size() const {
+    return codes.size();
+}
+
+std::string NGramTable::sequence(size_t k) const {
+    std::string result(n, 'A');
+    uint64_t code = codes[k];
+    for (size_t i = n; i-- > 0;) {
+        result[i] = static_cast<char>('A' + code % 26);
+        code /= 26;
+    }
+    return result;
+}
+
+FrequencyAccumulator::FrequencyAccumulator()
+    : bigrams(26 * 26, 0), trigrams(26 * 26 * 26, 0), total(0), head{}, tail{} {
+    letters.fill(0);
+}
+
+// The n-gram counts need every letter classified in order anyway, so the
+// unigrams are counted in the same pass rather than by a separate kernel scan
+// (see make histogram-bench).
+void FrequencyAccumulator::add(const char* data, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t letter = HistogramKernel::letterIndex(bytes[i]);
+        if (letter != HistogramKernel::NOT_A_LETTER) {
+            letters[letter]++;
+            pushLetter(letter);
+        }
+    }
+}
+
+void FrequencyAccumulator::add(const std::string& text) {
+    add(text.data(), text.length());
+}
+
+void FrequencyAccumulator::pushLetter(uint8_t letter) {
+    if (total >= 1) {
+        bigrams[tail[1] * 26 + letter]++;
+    }
+    if (total >= 2) {
+        trigrams[(tail[0] * 26 + tail[1]) * 26 + letter]++;
+    }
+    if (total < 2) {
+        head[total] = letter;
+    }
+    tail[0] = tail[1];
+    tail[1] = letter;
+    total++;
+}
+
+void FrequencyAccumulator::merge(const FrequencyAccumulator& next) {
+    if (next.total == 0) return;
+    if (total == 0) {
+        *this = next;
+        return;
+    }
+
+    for (size_t i = 0; i < letters.size(); ++i) letters[i] += next.letters[i];
+    for (size_t i = 0; i < bigrams.size(); ++i) bigrams[i] += next.bigrams[i];
+    for (size_t i = 0; i < trigrams.size(); ++i) trigrams[i] += next.trigrams[i];
+
+    // Stitch the n-grams that span the boundary
+    bigrams[tail[1] * 26 + next.head[0]]++;
+    if (total >= 2) {
+        trigrams[(tail[0] * 26 + tail[1]) * 26 + next.head[0]]++;
+    }
+    if (next.total >= 2) {
+        trigrams[(tail[1] * 26 + next.head[0]) * 26 + next.head[1]]++;
+    }
+
+    if (total == 1) {
+        head[1] = next.head[0];
+    }
+    if (next.total == 1) {
+        tail[0] = tail[1];
+        tail[1] = next.tail[1];
+    } else {
+        tail = next.tail;
+    }
+    total += next.total;
+}
+
+FrequencyAccumulator FrequencyAccumulator::countParallel(
+    const char* data, size_t length, size_t threads) {
+    ThreadPool& pool = ThreadPool::global();
+    if (threads == 0) {
+        threads = pool.size();
+    }
+    // Small inputs are not worth a task each
+    const size_t minChunk = 1 << 16;
+    threads = std::max<size_t>(1, std::min(threads, length / minChunk));
+
+    std::vector<FrequencyAccumulator> partials(threads);
+    size_t chunkSize = length / threads;
+
+    pool.parallelFor(threads, 1, [&partials, data, length, chunkSize, threads](size_t first, size_t last) {
+        for (size_t t = first; t < last; ++t) {
+            size_t begin = t * chunkSize;
+            size_t end = (t == threads - 1) ? length : begin + chunkSize;
+            partials[t].add(data + begin, end - begin);
+        }
+    });
+
+    FrequencyAccumulator merged;
+    for (const auto& partial : partials) {
+        merged.merge(partial);
+    }
+    return merged;
+}
+
+FrequencyAccumulator FrequencyAccumulator::countFile(const std::string& path, size_t threads) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat file: " + path);
+    }
+
+    size_t length = static_cast<size_t>(info.st_size);
+    if (length == 0) {
+        close(fd);
+        return FrequencyAccumulator();
+    }
+
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+
+    FrequencyAccumulator result = countParallel(static_cast<const char*>(mapped), length, threads);
+    munmap(mapped, length);
+    return result;
+}
+
+uint64_t FrequencyAccumulator::totalLetters() const {
+    return total;
+}
+
+uint64_t FrequencyAccumulator::letterCount(int letter) const {
+    return letters[letter];
+}
+
+uint64_t FrequencyAccumulator::bigramCount(int first, int second) const {
+    return bigrams[first * 26 + second];
+}
+
+uint64_t FrequencyAccumulator::trigramCount(int first, int second, int third) const {
+    return trigrams[(first * 26 + second) * 26 + third];
+}
+
+uint64_t FrequencyAccumulator::coincidencePairs() const {
+    uint64_t pairs = 0;
+    for (uint64_t count : letters) {
+        if (count > 1) pairs += count * (count - 1);
+    }
+    return pairs;
+}
+
+const std::array<uint64_t, 26>& FrequencyAccumulator::getLetterCounts() const {
+    return letters;
+}
+
 // Constructor with text normalization
 FrequencyAnalyzer::FrequencyAnalyzer(const std::string& text) 
     : text(normalizeText(text)) {
     if (text.empty()) {
         throw std::invalid_argument("Input text cannot be empty");
     }
+    counts.add(this->text);
+}
+
+FrequencyAnalyzer::FrequencyAnalyzer(const FrequencyAccumulator& counts)
+    : counts(counts) {
+    if (counts.totalLetters() == 0) {
+        throw std::invalid_argument("Input text cannot be empty");
+    }
 }
 
 // analyze character frequencies 
 std::vector<FrequencyData> FrequencyAnalyzer::analyzeCharacterFrequencies() const {
     std::vector<FrequencyData> frequencies;
-    std::map<char, int> charCount;
-    
-    // Count occurrences
-    for (char c : text) {
-        if (isValidChar(c)) {
-            charCount[c]++;
-        }
-    }
     
-    // Calculate frequencies
-    size_t totalChars = text.length();
-    for (const auto& pair : charCount) {
+    // Calculate frequencies from the merged letter counts
+    uint64_t totalChars = counts.totalLetters();
+    for (int letter = 0; letter < 26; ++letter) {
+        uint64_t count = counts.letterCount(letter);
+        if (count == 0) continue;
+
         FrequencyData data;
-        data.character = pair.first;
-        data.count = pair.second;
-        data.frequency = calculateFrequency(pair.second, totalChars);
-        data.expectedFrequency = ENGLISH_FREQUENCIES[pair.first - 'A'];
+        data.character = static_cast<char>('A' + letter);
+        data.count = static_cast<int>(count);
+        data.frequency = calculateFrequency(static_cast<int>(count), totalChars);
+        data.expectedFrequency = ENGLISH_FREQUENCIES[letter];
         data.deviation = std::abs(data.frequency - data.expectedFrequency);
         
         frequencies.push_back(data);
     }
     
     // Sort by frequency
-    std::sort(frequencies.begin(), frequencies.end(),
+    std::stable_sort(frequencies.begin(), frequencies.end(),
               [](const FrequencyData& a, const FrequencyData& b) {
                   return a.frequency > b.frequency;
               });
@@ -59,44 +239,154 @@ std::vector<FrequencyData> FrequencyAnalyzer::analyzeCharacterFrequencies() cons
 }
 
 std::vector<NGramData> FrequencyAnalyzer::analyzeNGrams(size_t n) const {
+    if (text.empty() && n <= 3) {
+        return ngramsFromCounts(n);
+    }
+    if (n > MAX_PACKED_NGRAM) {
+        return ngramsBySubstring(n);
+    }
+
     std::vector<NGramData> ngrams;
-    std::map<std::string, NGramData> ngramMap;
+    NGramTable table = buildNGramTable(n);
+    ngrams.reserve(table.size());
+
+    for (size_t k = 0; k < table.size(); ++k) {
+        auto first = table.positions.begin() + table.offsets[k];
+        ngrams.push_back({
+            table.sequence(k),
+            static_cast<int>(table.counts[k]),
+            calculateFrequency(static_cast<int>(table.counts[k]), table.totalNGrams),
+            std::vector<size_t>(first, first + table.counts[k])
+        });
+    }
     
-    // Get n-gram probabilities from entropy calculator
-    auto ngramProbabilities = entropyCalc.calculateNGramProbabilities(text, n);
-    auto extractedNGrams = entropyCalc.extractNGrams(text, n);
+    // Sort by frequency; ties keep alphabetical order
+    std::stable_sort(ngrams.begin(), ngrams.end(),
+        [](const NGramData& a, const NGramData& b) {
+            return a.frequency > b.frequency;
+        });
     
-    // Track positions and counts
-    for (size_t i = 0; i <= text.length() - n; ++i) {
-        std::string sequence = text.substr(i, n);
-        
-        if (ngramMap.find(sequence) == ngramMap.end()) {
-            ngramMap[sequence] = {
-                sequence,
-                1,
-                ngramProbabilities[sequence],
-                {i}
-            };
-        } else {
-            ngramMap[sequence].count++;
-            ngramMap[sequence].positions.push_back(i);
+    return ngrams;
+}
+
+// N-grams too long to pack are grouped by sorting (substring, position)
+// pairs; equal substrings end up adjacent with their positions ascending.
+std::vector<NGramData> FrequencyAnalyzer::ngramsBySubstring(size_t n) const {
+    std::vector<NGramData> ngrams;
+    if (n == 0 || text.length() < n) {
+        return ngrams;
+    }
+
+    size_t total = text.length() - n + 1;
+    std::vector<std::pair<std::string_view, size_t>> keyed(total);
+    std::string_view view(text);
+    for (size_t i = 0; i < total; ++i) {
+        keyed[i] = {view.substr(i, n), i};
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    for (size_t i = 0; i < total; ++i) {
+        if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+            ngrams.push_back({std::string(keyed[i].first), 0, 0.0, {}});
         }
+        ngrams.back().count++;
+        ngrams.back().positions.push_back(keyed[i].second);
     }
-    
-    // Convert map to vector
-    for (const auto& pair : ngramMap) {
-        ngrams.push_back(pair.second);
+    for (auto& ngram : ngrams) {
+        ngram.frequency = calculateFrequency(ngram.count, total);
     }
-    
-    // Sort by frequency
-    std::sort(ngrams.begin(), ngrams.end(),
+
+    // Sort by frequency; ties keep alphabetical order
+    std::stable_sort(ngrams.begin(), ngrams.end(),
         [](const NGramData& a, const NGramData& b) {
             return a.frequency > b.frequency;
         });
-    
+
     return ngrams;
 }
 
+// Positions are grouped by a counting sort over the packed n-gram codes. For
+// n <= 4 the code space is small enough to bucket directly; longer n-grams
+// sort (code, position) pairs instead.
+NGramTable FrequencyAnalyzer::buildNGramTable(size_t n) const {
+    if (n > MAX_PACKED_NGRAM) {
+        throw std::invalid_argument("N-grams longer than " + std::to_string(MAX_PACKED_NGRAM) +
+                                    " letters cannot be packed");
+    }
+    NGramTable table;
+    table.n = n;
+    table.totalNGrams = 0;
+    if (n == 0 || text.length() < n) {
+        return table;
+    }
+    if (text.length() > UINT32_MAX) {
+        throw std::length_error("Text too long for 32-bit n-gram positions");
+    }
+
+    size_t total = text.length() - n + 1;
+    table.totalNGrams = total;
+    uint64_t codeSpace = 1;
+    for (size_t i = 0; i < n; ++i) codeSpace *= 26;
+    const uint64_t leadingWeight = codeSpace / 26;
+
+    // Rolling base-26 code of the n-gram ending at each position. The letter
+    // leaving the window is subtracted before the shift, so the code stays
+    // below 26^n and never overflows.
+    std::vector<uint64_t> codes(total);
+    uint64_t code = 0;
+    for (size_t i = 0; i < text.length(); ++i) {
+        if (i >= n) {
+            code -= static_cast<uint64_t>(text[i - n] - 'A') * leadingWeight;
+        }
+        code = code * 26 + static_cast<uint64_t>(text[i] - 'A');
+        if (i + 1 >= n) {
+            codes[i + 1 - n] = code;
+        }
+    }
+
+    table.positions.resize(total);
+
+    if (n <= 4) {
+        std::vector<uint32_t> buckets(codeSpace, 0);
+        for (uint64_t c : codes) {
+            buckets[c]++;
+        }
+
+        uint32_t offset = 0;
+        for (uint64_t c = 0; c < codeSpace; ++c) {
+            if (buckets[c] == 0) continue;
+            table.codes.push_back(c);
+            table.offsets.push_back(offset);
+            table.counts.push_back(buckets[c]);
+            uint32_t count = buckets[c];
+            buckets[c] = offset;  // reuse as the write cursor
+            offset += count;
+        }
+
+        for (size_t i = 0; i < total; ++i) {
+            table.positions[buckets[codes[i]]++] = static_cast<uint32_t>(i);
+        }
+    } else {
+        std::vector<std::pair<uint64_t, uint32_t>> keyed(total);
+        for (size_t i = 0; i < total; ++i) {
+            keyed[i] = {codes[i], static_cast<uint32_t>(i)};
+        }
+        std::sort(keyed.begin(), keyed.end());
+
+        for (size_t i = 0; i < total; ++i) {
+            if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+                table.codes.push_back(keyed[i].first);
+                table.offsets.push_back(static_cast<uint32_t>(i));
+                table.counts.push_back(0);
+            }
+            table.counts.back()++;
+            table.positions[i] = keyed[i].second;
+        }
+    }
+
+    return table;
+}
+
 std::vector<NGramData> FrequencyAnalyzer::analyzeBigrams() const {
     return analyzeNGrams(2);
 }
@@ -106,32 +396,19 @@ std::vector<NGramData> FrequencyAnalyzer::analyzeTrigrams() const {
 }
 
 double FrequencyAnalyzer::calculateIndexOfCoincidence() const {
-    std::vector<int> frequencies(26, 0);
-    size_t totalChars = 0;
-    
-    for (char c : text) {
-        if (isValidChar(c)) {
-            frequencies[c - 'A']++;
-            totalChars++;
-        }
-    }
-    
-    double ic = 0.0;
-    for (int freq : frequencies) {
-        ic += (freq * (freq - 1));
-    }
-    
-    return ic / (totalChars * (totalChars - 1));
+    double totalChars = static_cast<double>(counts.totalLetters());
+    return counts.coincidencePairs() / (totalChars * (totalChars - 1));
 }
 
 double FrequencyAnalyzer::calculateChiSquared() const {
-    auto observed = analyzeCharacterFrequencies();
     double chiSquared = 0.0;
-    size_t totalChars = text.length();
+    double totalChars = static_cast<double>(counts.totalLetters());
     
-    for (const auto& data : observed) {
-        double expected = totalChars * ENGLISH_FREQUENCIES[data.character - 'A'];
-        double difference = data.count - expected;
+    for (int letter = 0; letter < 26; ++letter) {
+        uint64_t count = counts.letterCount(letter);
+        if (count == 0) continue;
+        double expected = totalChars * ENGLISH_FREQUENCIES[letter];
+        double difference = count - expected;
         chiSquared += (difference * difference) / expected;
     }
     
@@ -199,7 +476,7 @@ std::string FrequencyAnalyzer::getNormalizedText() const {
 }
 
 size_t FrequencyAnalyzer::getTextLength() const {
-    return text.length();
+    return static_cast<size_t>(counts.totalLetters());
 }
 
 std::string FrequencyAnalyzer::normalizeText(const std::string& input) const {
@@ -221,3 +498,43 @@ double FrequencyAnalyzer::calculateFrequency(int count, size_t total) const {
 }
 
 
+
+// Counts-only n-gram table for analyzers built from a FrequencyAccumulator
+std::vector<NGramData> FrequencyAnalyzer::ngramsFromCounts(size_t n) const {
+    std::vector<NGramData> ngrams;
+    uint64_t totalLetters = counts.totalLetters();
+    if (n == 0 || totalLetters < n) return ngrams;
+
+    size_t total = static_cast<size_t>(totalLetters - n + 1);
+    size_t codes = 1;
+    for (size_t i = 0; i < n; ++i) codes *= 26;
+
+    for (size_t code = 0; code < codes; ++code) {
+        std::string sequence(n, 'A');
+        size_t rest = code;
+        for (size_t i = n; i-- > 0;) {
+            sequence[i] = static_cast<char>('A' + rest % 26);
+            rest /= 26;
+        }
+
+        uint64_t count;
+        if (n == 1) {
+            count = counts.letterCount(sequence[0] - 'A');
+        } else if (n == 2) {
+            count = counts.bigramCount(sequence[0] - 'A', sequence[1] - 'A');
+        } else {
+            count = counts.trigramCount(sequence[0] - 'A', sequence[1] - 'A', sequence[2] - 'A');
+        }
+        if (count == 0) continue;
+
+        ngrams.push_back({sequence, static_cast<int>(count),
+                          calculateFrequency(static_cast<int>(count), total), {}});
+    }
+
+    std::stable_sort(ngrams.begin(), ngrams.end(),
+        [](const NGramData& a, const NGramData& b) {
+            return a.frequency > b.frequency;
+        });
+
+    return ngrams;
+}
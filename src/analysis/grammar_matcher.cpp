@@ -0,0 +1,165 @@
+#include "../../include/analysis/grammar_matcher.hpp"
+#include <algorithm>
+
+namespace {
+bool isWordChar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool isSpaceChar(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+bool isWordString(const std::string& s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](char c) {
+        return isWordChar(static_cast<unsigned char>(c));
+    });
+}
+
+bool consumePrefix(const std::string& s, size_t& pos, const char* prefix) {
+    std::string p(prefix);
+    if (s.compare(pos, p.length(), p) != 0) return false;
+    pos += p.length();
+    return true;
+}
+}
+
+GrammarMatcher::GrammarMatcher() {
+}
+
+// Recognises \b(w1|w2|...)\s+\w+ with plain word alternatives
+bool GrammarMatcher::parseWordThenWord(const std::string& pattern, std::vector<std::string>& words) {
+    size_t pos = 0;
+    if (!consumePrefix(pattern, pos, "\\b(")) return false;
+    size_t close = pattern.find(')', pos);
+    if (close == std::string::npos) return false;
+
+    std::string alternatives = pattern.substr(pos, close - pos);
+    pos = close + 1;
+    if (!consumePrefix(pattern, pos, "\\s+\\w+") || pos != pattern.length()) return false;
+
+    words.clear();
+    size_t start = 0;
+    while (true) {
+        size_t bar = alternatives.find('|', start);
+        std::string word = alternatives.substr(start, bar == std::string::npos ? std::string::npos : bar - start);
+        if (!isWordString(word)) return false;
+        words.push_back(word);
+        if (bar == std::string::npos) break;
+        start = bar + 1;
+    }
+    return true;
+}
+
+// Recognises \b\w+SUFFIX\b with a plain word suffix
+bool GrammarMatcher::parseSuffix(const std::string& pattern, std::string& suffix) {
+    const std::string head = "\\b\\w+";
+    const std::string tail = "\\b";
+    if (pattern.length() <= head.length() + tail.length()) return false;
+    if (pattern.compare(0, head.length(), head) != 0) return false;
+    if (pattern.compare(pattern.length() - tail.length(), tail.length(), tail) != 0) return false;
+
+    suffix = pattern.substr(head.length(), pattern.length() - head.length() - tail.length());
+    return isWordString(suffix);
+}
+
+void GrammarMatcher::addPattern(const std::string& pattern) {
+    size_t index = rules.size();
+    Rule rule;
+    std::vector<std::string> words;
+
+    if (parseWordThenWord(pattern, words)) {
+        rule.kind = WORD_THEN_WORD;
+        wordRules.push_back(index);
+        for (const auto& word : words) {
+            auto& starts = leadWords[word];
+            if (starts.empty() || starts.back() != index) starts.push_back(index);
+        }
+    } else if (parseSuffix(pattern, rule.suffix)) {
+        rule.kind = SUFFIX;
+        suffixRules.push_back(index);
+    } else {
+        rule.kind = REGEX;
+        rule.regex = std::regex(pattern);
+        regexRules.push_back(index);
+    }
+
+    rules.push_back(std::move(rule));
+}
+
+void GrammarMatcher::clear() {
+    rules.clear();
+    wordRules.clear();
+    suffixRules.clear();
+    regexRules.clear();
+    leadWords.clear();
+}
+
+size_t GrammarMatcher::patternCount() const {
+    return rules.size();
+}
+
+// Walks the tokens once with one token of lookahead. A WORD_THEN_WORD match
+// consumes the following token as well, so that token cannot start another
+// match of the same rule, mirroring how sregex_iterator resumes.
+std::vector<size_t> GrammarMatcher::countMatches(const std::string& text) const {
+    std::vector<size_t> counts(rules.size(), 0);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.length();
+
+    auto nextToken = [&](size_t from, size_t& start, size_t& end) {
+        while (from < n && !isWordChar(data[from])) ++from;
+        start = from;
+        while (from < n && isWordChar(data[from])) ++from;
+        end = from;
+        return start < n;
+    };
+
+    if (!wordRules.empty() || !suffixRules.empty()) {
+        // consumedAt[r] = start of the token rule r consumed last, n if none
+        std::vector<size_t> consumedAt(rules.size(), n);
+        std::string token;
+        size_t start, end;
+        bool have = nextToken(0, start, end);
+
+        while (have) {
+            size_t nextStart, nextEnd;
+            bool haveNext = nextToken(end, nextStart, nextEnd);
+            size_t length = end - start;
+
+            for (size_t r : suffixRules) {
+                const std::string& suffix = rules[r].suffix;
+                if (length > suffix.length() &&
+                    text.compare(end - suffix.length(), suffix.length(), suffix) == 0) {
+                    counts[r]++;
+                }
+            }
+
+            if (haveNext && !leadWords.empty()) {
+                token.assign(text, start, length);
+                auto it = leadWords.find(token);
+                if (it != leadWords.end()) {
+                    bool spaceOnly = std::all_of(data + end, data + nextStart, isSpaceChar);
+                    if (spaceOnly) {
+                        for (size_t r : it->second) {
+                            if (consumedAt[r] == start) continue;
+                            counts[r]++;
+                            consumedAt[r] = nextStart;
+                        }
+                    }
+                }
+            }
+
+            start = nextStart;
+            end = nextEnd;
+            have = haveNext;
+        }
+    }
+
+    for (size_t r : regexRules) {
+        auto begin = std::sregex_iterator(text.begin(), text.end(), rules[r].regex);
+        counts[r] = static_cast<size_t>(std::distance(begin, std::sregex_iterator()));
+    }
+
+    return counts;
+}
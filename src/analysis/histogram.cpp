@@ -0,0 +1,89 @@
+#include "../../include/analysis/histogram.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr size_t BANKS = 4;
+// Per-bank counters are 32-bit; fold them into the caller's totals before
+// any single bank could overflow.
+constexpr size_t FLUSH_INTERVAL = size_t(1) << 30;
+// Below this many bytes, clearing and folding the banks costs more than the
+// counter stalls they avoid, so short inputs are counted directly.
+constexpr size_t SHORT_INPUT = 256;
+
+constexpr std::array<uint8_t, 256> makeLetterIndex() {
+    std::array<uint8_t, 256> index{};
+    for (int c = 0; c < 256; ++c) {
+        unsigned folded = static_cast<unsigned>(c | 0x20) - 'a';
+        index[c] = folded < 26 ? static_cast<uint8_t>(folded) : HistogramKernel::NOT_A_LETTER;
+    }
+    return index;
+}
+
+void countBytesChunk(const unsigned char* bytes, size_t length, std::array<uint64_t, 256>& counts) {
+    uint32_t banks[BANKS][256] = {};
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        banks[0][word & 0xFF]++;
+        banks[1][(word >> 8) & 0xFF]++;
+        banks[2][(word >> 16) & 0xFF]++;
+        banks[3][(word >> 24) & 0xFF]++;
+        banks[0][(word >> 32) & 0xFF]++;
+        banks[1][(word >> 40) & 0xFF]++;
+        banks[2][(word >> 48) & 0xFF]++;
+        banks[3][word >> 56]++;
+    }
+    for (; i < length; ++i) {
+        banks[0][bytes[i]]++;
+    }
+
+    for (size_t b = 0; b < 256; ++b) {
+        counts[b] += static_cast<uint64_t>(banks[0][b]) + banks[1][b] + banks[2][b] + banks[3][b];
+    }
+}
+}
+
+void HistogramKernel::countBytes(const char* data, size_t length, std::array<uint64_t, 256>& counts) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (length < SHORT_INPUT) {
+        for (size_t i = 0; i < length; ++i) counts[bytes[i]]++;
+        return;
+    }
+    for (size_t offset = 0; offset < length; offset += FLUSH_INTERVAL) {
+        countBytesChunk(bytes + offset, std::min(FLUSH_INTERVAL, length - offset), counts);
+    }
+}
+
+// Classification and case folding are applied to the 256 byte bins rather
+// than to every input byte, so letters cost the same as a byte histogram.
+uint64_t HistogramKernel::countLetters(const char* data, size_t length, std::array<uint64_t, 26>& counts) {
+    if (length < SHORT_INPUT) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        uint64_t letters = 0;
+        for (size_t i = 0; i < length; ++i) {
+            uint8_t letter = letterIndex(bytes[i]);
+            if (letter != NOT_A_LETTER) {
+                counts[letter]++;
+                letters++;
+            }
+        }
+        return letters;
+    }
+
+    std::array<uint64_t, 256> byteCounts{};
+    countBytes(data, length, byteCounts);
+
+    uint64_t letters = 0;
+    for (size_t letter = 0; letter < 26; ++letter) {
+        uint64_t count = byteCounts['A' + letter] + byteCounts['a' + letter];
+        counts[letter] += count;
+        letters += count;
+    }
+    return letters;
+}
+
+// Built at compile time, so it is ready before any static initializer runs
+const std::array<uint8_t, 256> HistogramKernel::LETTER_INDEX = makeLetterIndex();
@@ -1,16 +1,16 @@
 #include "../../include/analysis/language_matcher.hpp"
 #include "../../include/analysis/entropy_calculator.hpp"
+#include "../../include/concurrency/thread_pool.hpp"
+#include "../../include/dictionary/dictionary_cache.hpp"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <cmath>
-#include <curl/curl.h>
-#include <regex>
+#include <numeric>
 
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
+namespace {
+const std::string DEFAULT_DICTIONARY_SOURCE = "https://raw.githubusercontent.com/dwyl/english-words/master/words.txt";
 }
 
 // Enhanced constructors with better error handling
@@ -28,9 +28,12 @@ LanguageMatcher::LanguageMatcher(const std::vector<std::string>& wordList) {
     initializeDefaultPatterns();
 }
 
-LanguageMatcher::LanguageMatcher(bool downloadDict) {
-    if (downloadDict && !downloadDictionary()) {
-        throw std::runtime_error("Online dictionary download failed");
+LanguageMatcher::LanguageMatcher(bool downloadDict) : LanguageMatcher(downloadDict, DEFAULT_DICTIONARY_SOURCE) {
+}
+
+LanguageMatcher::LanguageMatcher(bool downloadDict, const std::string& dictionarySource) {
+    if (downloadDict && !downloadDictionary(dictionarySource)) {
+        throw std::runtime_error("Online dictionary download failed: " + dictionarySource);
     }
     initializeDefaultPatterns();
 }
@@ -47,17 +50,18 @@ MatchResult LanguageMatcher::analyzeText(const std::string& text) const {
     }
     
     // Calculate scores
-    result.wordFrequencyScore = calculateWordFrequencyScore(text);
-    result.structuralScore = calculateGrammarScore(text);
+    auto grammarCounts = grammarMatcher.countMatches(text);
+    result.wordFrequencyScore = wordFrequencyScore(words);
+    result.structuralScore = grammarScoreFromCounts(grammarCounts);
     
     // Calculate overall confidence
     result.confidence = (result.wordFrequencyScore * 0.6 + 
                         result.structuralScore * 0.4);
     
     // Find grammar matches
+    size_t index = 0;
     for (const auto& pattern : grammarPatterns) {
-        std::regex re(pattern.first);
-        if (std::regex_search(text, re)) {
+        if (grammarCounts[index++] > 0) {
             result.grammarMatches.insert(
                 result.grammarMatches.end(),
                 pattern.second.begin(),
@@ -101,6 +105,91 @@ std::vector<std::string> LanguageMatcher::identifyValidWords(const std::string&
 
 void LanguageMatcher::addLanguageProfile(const LanguageProfile& profile) {
     languageProfiles.push_back(profile);
+    compileLanguageProfiles();
+
+    NGramLanguageModel& model = characterModel(profile.name);
+    for (const auto& entry : profile.wordFrequencies) {
+        model.addWord(entry.first, entry.second);
+    }
+    model.finalize();
+}
+
+void LanguageMatcher::setLanguageBackend(LanguageBackend backend) {
+    languageBackend = backend;
+}
+
+void LanguageMatcher::trainCharacterModel(const std::string& language, const std::string& sampleText) {
+    characterModel(language).train(sampleText);
+}
+
+NGramLanguageModel& LanguageMatcher::characterModel(const std::string& language) {
+    for (auto& model : characterModels) {
+        if (model.getName() == language) {
+            return model;
+        }
+    }
+    characterModels.emplace_back(language);
+    return characterModels.back();
+}
+
+// Posterior of each language under equal priors, from the summed n-gram log-likelihoods
+std::vector<std::pair<std::string, double>>
+LanguageMatcher::detectByCharacterModels(const std::string& text) const {
+    std::vector<std::pair<std::string, double>> results;
+    if (characterModels.empty()) {
+        return results;
+    }
+
+    std::vector<double> logLikelihoods;
+    for (const auto& model : characterModels) {
+        logLikelihoods.push_back(model.logLikelihood(text));
+    }
+    double best = *std::max_element(logLikelihoods.begin(), logLikelihoods.end());
+    double normalizer = 0.0;
+    for (double value : logLikelihoods) {
+        normalizer += std::exp(value - best);
+    }
+
+    for (size_t i = 0; i < characterModels.size(); ++i) {
+        results.push_back({characterModels[i].getName(), std::exp(logLikelihoods[i] - best) / normalizer});
+    }
+    std::sort(results.begin(), results.end(),
+              [](const auto& a, const auto& b) {
+                  return a.second > b.second;
+              });
+    return results;
+}
+
+void LanguageMatcher::compileLanguageProfiles() {
+    vocabularyIds.clear();
+    for (const auto& profile : languageProfiles) {
+        for (const auto& entry : profile.wordFrequencies) {
+            vocabularyIds.emplace(entry.first, static_cast<uint32_t>(vocabularyIds.size()));
+        }
+    }
+
+    size_t profiles = languageProfiles.size();
+    profileWeights.assign(vocabularyIds.size() * profiles, 0.0);
+    profileMembership.assign(vocabularyIds.size() * profiles, 0);
+    for (size_t p = 0; p < profiles; ++p) {
+        for (const auto& entry : languageProfiles[p].wordFrequencies) {
+            size_t cell = vocabularyIds[entry.first] * profiles + p;
+            profileWeights[cell] = entry.second;
+            profileMembership[cell] = 1;
+        }
+    }
+}
+
+std::vector<std::pair<uint32_t, uint32_t>>
+LanguageMatcher::countVocabulary(const std::vector<std::string>& words) const {
+    std::unordered_map<uint32_t, uint32_t> counts;
+    for (const auto& word : words) {
+        auto it = vocabularyIds.find(normalizeWord(word));
+        if (it != vocabularyIds.end()) {
+            counts[it->second]++;
+        }
+    }
+    return std::vector<std::pair<uint32_t, uint32_t>>(counts.begin(), counts.end());
 }
 
 void LanguageMatcher::loadLanguageRules(const std::string& rulesFile) {
@@ -124,25 +213,31 @@ void LanguageMatcher::loadLanguageRules(const std::string& rulesFile) {
             grammarPatterns[pattern] = ruleList;
         }
     }
+
+    compileGrammarPatterns();
 }
 
 std::vector<std::pair<std::string, double>> 
 LanguageMatcher::detectPossibleLanguages(const std::string& text) const {
+    if (languageBackend == CHARACTER_NGRAM_BACKEND) {
+        return detectByCharacterModels(text);
+    }
+
     std::vector<std::pair<std::string, double>> results;
-    
-    for (const auto& profile : languageProfiles) {
-        double confidence = 0.0;
-        auto words = tokenizeText(text);
-        
-        for (const auto& word : words) {
-            auto it = profile.wordFrequencies.find(normalizeWord(word));
-            if (it != profile.wordFrequencies.end()) {
-                confidence += it->second;
-            }
+    auto words = tokenizeText(text);
+    size_t profiles = languageProfiles.size();
+
+    // Sparse word counts times the word-major weight matrix scores every profile at once
+    std::vector<double> confidence(profiles, 0.0);
+    for (const auto& entry : countVocabulary(words)) {
+        const double* row = &profileWeights[static_cast<size_t>(entry.first) * profiles];
+        for (size_t p = 0; p < profiles; ++p) {
+            confidence[p] += entry.second * row[p];
         }
-        
-        confidence /= words.size();
-        results.push_back({profile.name, confidence});
+    }
+
+    for (size_t p = 0; p < profiles; ++p) {
+        results.push_back({languageProfiles[p].name, confidence[p] / words.size()});
     }
     
     std::sort(results.begin(), results.end(),
@@ -166,45 +261,36 @@ bool LanguageMatcher::isValidWord(const std::string& word) const {
 }
 
 double LanguageMatcher::calculateWordFrequencyScore(const std::string& text) const {
-    auto words = tokenizeText(text);
-    std::map<std::string, int> wordCounts;
-    
-    for (const auto& word : words) {
-        wordCounts[normalizeWord(word)]++;
-    }
-    
+    return wordFrequencyScore(tokenizeText(text));
+}
+
+double LanguageMatcher::wordFrequencyScore(const std::vector<std::string>& words) const {
+    size_t profiles = languageProfiles.size();
     double score = 0.0;
-    for (const auto& profile : languageProfiles) {
-        for (const auto& count : wordCounts) {
-            auto it = profile.wordFrequencies.find(count.first);
-            if (it != profile.wordFrequencies.end()) {
-                score += std::abs(it->second - 
-                    (static_cast<double>(count.second) / words.size()));
+
+    for (const auto& entry : countVocabulary(words)) {
+        double observed = static_cast<double>(entry.second) / words.size();
+        size_t row = static_cast<size_t>(entry.first) * profiles;
+        for (size_t p = 0; p < profiles; ++p) {
+            if (profileMembership[row + p]) {
+                score += std::abs(profileWeights[row + p] - observed);
             }
         }
     }
     
-    return 1.0 - (score / languageProfiles.size());
+    return 1.0 - (score / profiles);
 }
 
 double LanguageMatcher::calculateGrammarScore(const std::string& text) const {
-    double score = 0.0;
-    int patternMatches = 0;
-    
-    for (const auto& pattern : grammarPatterns) {
-        std::regex re(pattern.first);
-        auto words_begin = 
-            std::sregex_iterator(text.begin(), text.end(), re);
-        auto words_end = std::sregex_iterator();
-        
-        patternMatches += std::distance(words_begin, words_end);
-    }
-    
-    if (!grammarPatterns.empty()) {
-        score = static_cast<double>(patternMatches) / grammarPatterns.size();
+    return grammarScoreFromCounts(grammarMatcher.countMatches(text));
+}
+
+double LanguageMatcher::grammarScoreFromCounts(const std::vector<size_t>& counts) const {
+    if (counts.empty()) {
+        return 0.0;
     }
-    
-    return score;
+    size_t patternMatches = std::accumulate(counts.begin(), counts.end(), size_t(0));
+    return static_cast<double>(patternMatches) / counts.size();
 }
 
 std::vector<std::string> LanguageMatcher::findCommonPhrases(const std::string& text) const {
@@ -266,34 +352,31 @@ void LanguageMatcher::initializeDefaultPatterns() {
     grammarPatterns["\\b\\w+ing\\b"] = {"present_participle"};
     grammarPatterns["\\b\\w+ed\\b"] = {"past_tense"};
     grammarPatterns["\\b(very|quite|rather)\\s+\\w+"] = {"intensifier"};
+    compileGrammarPatterns();
 }
-// Add this method to download the dictionary
-bool LanguageMatcher::downloadDictionary() {
-    CURL* curl = curl_easy_init();
-    std::string readBuffer;
-
-    if(curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, "https://raw.githubusercontent.com/dwyl/english-words/master/words.txt");
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
-
-        if(res != CURLE_OK) {
-            return false;
-        }
 
-        // Process the downloaded content
-        std::istringstream iss(readBuffer);
-        std::string word;
-        while (std::getline(iss, word)) {
-            dictionary.insert(normalizeWord(word));
-        }
-        
-        return true;
+// Patterns are compiled in map order so counts line up with grammarPatterns
+void LanguageMatcher::compileGrammarPatterns() {
+    grammarMatcher.clear();
+    for (const auto& pattern : grammarPatterns) {
+        grammarMatcher.addPattern(pattern.first);
     }
-    return false;
+}
+// Fetch a word list through the local cache; only the first use of a remote
+// source needs the network
+bool LanguageMatcher::downloadDictionary(const std::string& source) {
+    std::vector<std::string> words;
+    try {
+        words = DictionaryCache().load(source);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    // Cached lists are sorted, so each insert lands at the end of the set
+    for (const auto& word : words) {
+        dictionary.insert(dictionary.end(), word);
+    }
+    return true;
 }
 
 double LanguageMatcher::calculateWordSimilarity(
@@ -362,8 +445,9 @@ double LanguageMatcher::calculateTextComplexity(const std::string& text) const {
     std::set<std::string> uniqueWords(words.begin(), words.end());
     double uniqueRatio = static_cast<double>(uniqueWords.size()) / words.size();
     
-    // Get comprehensive entropy metrics
-    EntropyMetrics metrics = entropyCalc.calculateFullMetrics(text);
+    // Only the three entropy features used below are computed
+    EntropySummary metrics = entropyCalc.calculateMetrics(
+        text, METRIC_SHANNON | METRIC_NORMALIZED | METRIC_CONDITIONAL);
     
     // Enhanced complexity calculation using multiple entropy features
     double entropyScore = (metrics.shannonEntropy * 0.4 + 
@@ -379,38 +463,33 @@ LanguageMatcher::findSimilarWords(const std::string& word, double threshold) con
     std::vector<std::pair<std::string, std::string>> similarWords;
     std::string normalizedInput = normalizeWord(word);
     
-    // Parallel processing for large dictionaries
-    const size_t threadCount = std::thread::hardware_concurrency();
-    std::vector<std::future<std::vector<std::pair<std::string, std::string>>>> futures;
-    
-    auto processWords = [this, &normalizedInput, threshold]
-        (const std::vector<std::string>& wordBatch) {
-        std::vector<std::pair<std::string, std::string>> results;
-        for (const auto& dictWord : wordBatch) {
-            double similarity = calculateWordSimilarity(normalizedInput, dictWord);
+    // Score the dictionary in chunks on the shared pool; each chunk keeps its
+    // own results so they can be joined in dictionary order afterwards
+    std::vector<const std::string*> dictWords;
+    dictWords.reserve(dictionary.size());
+    for (const auto& dictWord : dictionary) {
+        dictWords.push_back(&dictWord);
+    }
+
+    ThreadPool& pool = ThreadPool::global();
+    size_t grain = std::max<size_t>(256, dictWords.size() / (pool.size() * 4) + 1);
+    size_t chunks = (dictWords.size() + grain - 1) / grain;
+    std::vector<std::vector<std::pair<std::string, std::string>>> chunkResults(chunks);
+
+    pool.parallelFor(dictWords.size(), grain, [&](size_t begin, size_t end) {
+        auto& results = chunkResults[begin / grain];
+        for (size_t i = begin; i < end; ++i) {
+            double similarity = calculateWordSimilarity(normalizedInput, *dictWords[i]);
             if (similarity >= threshold) {
-                results.emplace_back(dictWord, std::to_string(similarity));
+                results.emplace_back(*dictWords[i], std::to_string(similarity));
             }
         }
-        return results;
-    };
-    
-    // Split dictionary into batches
-    std::vector<std::string> dictVec(dictionary.begin(), dictionary.end());
-    size_t batchSize = dictVec.size() / threadCount;
-    
-    for (size_t i = 0; i < threadCount; ++i) {
-        auto start = dictVec.begin() + i * batchSize;
-        auto end = (i == threadCount - 1) ? dictVec.end() : start + batchSize;
-        std::vector<std::string> batch(start, end);
-        
-        futures.push_back(std::async(std::launch::async, processWords, batch));
-    }
-    
-    // Collect results
-    for (auto& future : futures) {
-        auto results = future.get();
-        similarWords.insert(similarWords.end(), results.begin(), results.end());
+    });
+
+    for (auto& results : chunkResults) {
+        similarWords.insert(similarWords.end(),
+                            std::make_move_iterator(results.begin()),
+                            std::make_move_iterator(results.end()));
     }
     
     return similarWords;
@@ -0,0 +1,156 @@
+#include "../../include/analysis/ngram_language_model.hpp"
+#include "../../include/analysis/histogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr uint8_t BOUNDARY = 27;
+constexpr unsigned SYMBOL_BITS = 5;
+constexpr double UNTRAINED_LOG_PROB = -20.0;
+constexpr size_t MAX_QUANTIZED = 255;
+
+// Letters become 1-26; any run of other bytes becomes one boundary, and the
+// sequence is padded with a boundary at each end.
+std::vector<uint8_t> toSymbols(const std::string& text) {
+    std::vector<uint8_t> symbols;
+    symbols.reserve(text.length() + 2);
+    symbols.push_back(BOUNDARY);
+    for (char c : text) {
+        uint8_t index = HistogramKernel::letterIndex(static_cast<unsigned char>(c));
+        if (index != HistogramKernel::NOT_A_LETTER) {
+            symbols.push_back(static_cast<uint8_t>(index + 1));
+        } else if (symbols.back() != BOUNDARY) {
+            symbols.push_back(BOUNDARY);
+        }
+    }
+    if (symbols.back() != BOUNDARY) symbols.push_back(BOUNDARY);
+    return symbols;
+}
+
+// Symbols are never 0, so the order is the number of non-zero 5-bit groups
+size_t orderOf(uint32_t code) {
+    size_t order = 0;
+    while (code) {
+        code >>= SYMBOL_BITS;
+        ++order;
+    }
+    return order;
+}
+
+// Calls visit(code, order) for every n-gram of order 1-4 ending at each symbol
+template <typename Visit>
+void forEachNGram(const std::vector<uint8_t>& symbols, Visit&& visit) {
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        uint32_t code = 0;
+        for (size_t n = 1; n <= NGramLanguageModel::MAX_ORDER && n <= i + 1; ++n) {
+            code |= static_cast<uint32_t>(symbols[i + 1 - n]) << (SYMBOL_BITS * (n - 1));
+            visit(code, n);
+        }
+    }
+}
+}
+
+NGramLanguageModel::NGramLanguageModel(const std::string& name, size_t tableSize)
+    : name(name), tableBits(0), quantStep(0.0), stored(0) {
+    if (tableSize < 2 || (tableSize & (tableSize - 1)) != 0) {
+        throw std::invalid_argument("N-gram table size must be a power of two");
+    }
+    while ((size_t(1) << tableBits) < tableSize) ++tableBits;
+    slots.assign(tableSize, 0);
+    std::fill(std::begin(unseenLogProb), std::end(unseenLogProb), UNTRAINED_LOG_PROB);
+    std::fill(std::begin(orderTotals), std::end(orderTotals), 0.0);
+}
+
+void NGramLanguageModel::train(const std::string& text, double weight) {
+    countSymbols(toSymbols(text), weight);
+    finalize();
+}
+
+void NGramLanguageModel::addWord(const std::string& word, double weight) {
+    countSymbols(toSymbols(word), weight);
+}
+
+void NGramLanguageModel::countSymbols(const std::vector<uint8_t>& symbols, double weight) {
+    if (weight <= 0.0) return;
+    forEachNGram(symbols, [&](uint32_t code, size_t order) {
+        trainingCounts[code] += weight;
+        orderTotals[order] += weight;
+    });
+}
+
+// Keeps the most frequent n-grams up to a 3/4 load factor. Anything left out
+// is rarer than everything kept, so unseen n-grams get half the smallest kept
+// probability of their order.
+void NGramLanguageModel::finalize() {
+    std::vector<std::pair<uint32_t, double>> entries(trainingCounts.begin(), trainingCounts.end());
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    size_t capacity = slots.size() * 3 / 4;
+    if (entries.size() > capacity) entries.resize(capacity);
+
+    double smallestKept[MAX_ORDER + 1] = {};
+    std::vector<double> logProbs(entries.size());
+    double minLog = 0.0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        size_t order = orderOf(entries[i].first);
+        logProbs[i] = std::log(entries[i].second / orderTotals[order]);
+        minLog = std::min(minLog, logProbs[i]);
+        smallestKept[order] = entries[i].second;  // entries are in descending count order
+    }
+
+    double smallestOverall = entries.empty() ? 0.0 : entries.back().second;
+    for (size_t order = 1; order <= MAX_ORDER; ++order) {
+        if (orderTotals[order] <= 0.0) {
+            unseenLogProb[order] = UNTRAINED_LOG_PROB;
+            continue;
+        }
+        double floor = smallestKept[order] > 0.0 ? smallestKept[order] : smallestOverall;
+        unseenLogProb[order] = std::log(0.5 * floor / orderTotals[order]);
+    }
+
+    quantStep = minLog < 0.0 ? -minLog / MAX_QUANTIZED : 1.0;
+    std::fill(slots.begin(), slots.end(), 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto quantized = static_cast<uint32_t>(std::lround(-logProbs[i] / quantStep));
+        quantized = std::min<uint32_t>(quantized, MAX_QUANTIZED);
+        size_t slot = slotFor(entries[i].first);
+        while (slots[slot] != 0) slot = (slot + 1) & (slots.size() - 1);
+        slots[slot] = (entries[i].first << 8) | quantized;
+    }
+    stored = entries.size();
+}
+
+size_t NGramLanguageModel::slotFor(uint32_t code) const {
+    return static_cast<uint32_t>(code * 2654435761u) >> (32 - tableBits);
+}
+
+bool NGramLanguageModel::lookup(uint32_t code, uint8_t& quantized) const {
+    size_t mask = slots.size() - 1;
+    for (size_t slot = slotFor(code);; slot = (slot + 1) & mask) {
+        uint32_t entry = slots[slot];
+        if (entry == 0) return false;
+        if ((entry >> 8) == code) {
+            quantized = static_cast<uint8_t>(entry & 0xFF);
+            return true;
+        }
+    }
+}
+
+double NGramLanguageModel::logLikelihood(const std::string& text) const {
+    double total = 0.0;
+    forEachNGram(toSymbols(text), [&](uint32_t code, size_t order) {
+        uint8_t quantized;
+        total += lookup(code, quantized) ? -quantStep * quantized : unseenLogProb[order];
+    });
+    return total;
+}
+
+const std::string& NGramLanguageModel::getName() const {
+    return name;
+}
+
+size_t NGramLanguageModel::storedNGrams() const {
+    return stored;
+}
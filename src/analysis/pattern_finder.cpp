@@ -1,44 +1,69 @@
 #include "../../include/analysis/pattern_finder.hpp"
+#include "../../include/analysis/aho_corasick.hpp"
+#include "../../include/concurrency/thread_pool.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <set>
 #include <sstream>
 #include <numeric>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Expected index of coincidence for uniformly random letters and for English
+constexpr double RANDOM_IOC = 1.0 / 26.0;
+constexpr double ENGLISH_IOC = 0.0667;
+
+double scaleCoincidence(double value) {
+    double scaled = (value - RANDOM_IOC) / (ENGLISH_IOC - RANDOM_IOC);
+    return std::max(0.0, std::min(1.0, scaled));
+}
+}
+
 PatternFinder::PatternFinder(const std::string& text) 
-    : text(normalizeText(text)) {
+    : text(normalizeText(text)), suffixArray(this->text) {
 }
 
+// Suffixes sharing a prefix of length L are adjacent in the suffix array, so
+// each run of LCP values >= L is exactly one repeated L-gram.
 std::vector<Pattern> PatternFinder::findRepeatingPatterns(size_t minLength, size_t maxLength) const {
+    FSCT_TRACE_SCOPE("PatternFinder::findRepeatingPatterns");
     std::vector<Pattern> patterns;
+    const auto& suffixes = suffixArray.getSuffixes();
+    const auto& lcp = suffixArray.getLcp();
+    size_t n = suffixes.size();
     
-    for (size_t length = minLength; length <= maxLength; ++length) {
-        std::map<std::string, std::vector<size_t>> patternMap;
-        
-        // Find all patterns of current length
-        for (size_t i = 0; i <= text.length() - length; ++i) {
-            std::string currentPattern = text.substr(i, length);
-            if (isValidPattern(currentPattern)) {
-                patternMap[currentPattern].push_back(i);
+    for (size_t length = std::max<size_t>(minLength, 1); length <= maxLength; ++length) {
+        size_t i = 1;
+        while (i < n) {
+            if (lcp[i] < length) {
+                ++i;
+                continue;
             }
-        }
-        
-        // Add patterns that repeat
-        for (const auto& entry : patternMap) {
-            if (entry.second.size() > 1) {
-                Pattern p = {
-                    entry.first,
-                    entry.second,
-                    length,
-                    entry.second.size()
-                };
-                patterns.push_back(p);
+
+            size_t first = i - 1;
+            while (i < n && lcp[i] >= length) {
+                ++i;
             }
+
+            std::vector<size_t> positions(suffixes.begin() + first, suffixes.begin() + i);
+            std::sort(positions.begin(), positions.end());
+            size_t occurrences = positions.size();
+            patterns.push_back({
+                text.substr(positions[0], length),
+                std::move(positions),
+                length,
+                occurrences
+            });
         }
     }
     
     // Sort patterns by occurrence count
-    std::sort(patterns.begin(), patterns.end(),
+    std::stable_sort(patterns.begin(), patterns.end(),
               [](const Pattern& a, const Pattern& b) {
                   return a.occurrences > b.occurrences;
               });
@@ -46,6 +71,98 @@ std::vector<Pattern> PatternFinder::findRepeatingPatterns(size_t minLength, size
     return patterns;
 }
 
+std::vector<Pattern> PatternFinder::findMaximalRepeats(size_t minLength) const {
+    std::vector<Pattern> patterns;
+
+    forEachMaximalRepeat(minLength, [this, &patterns](const RepeatView& repeat) {
+        patterns.push_back({
+            text.substr(repeat.positions[0], repeat.length),
+            std::vector<size_t>(repeat.positions, repeat.positions + repeat.occurrences),
+            repeat.length,
+            repeat.occurrences
+        });
+        return true;
+    });
+
+    std::stable_sort(patterns.begin(), patterns.end(),
+              [](const Pattern& a, const Pattern& b) {
+                  if (a.occurrences != b.occurrences) return a.occurrences > b.occurrences;
+                  return a.length > b.length;
+              });
+
+    return patterns;
+}
+
+// Bottom-up traversal of the LCP intervals. Every interval is right-maximal by
+// construction; it is reported if it is also left-maximal, i.e. its
+// occurrences are not all preceded by the same letter. The preceding-letter
+// summary is merged from child intervals, so the traversal stays linear.
+void PatternFinder::forEachMaximalRepeat(
+    size_t minLength, const std::function<bool(const RepeatView&)>& visit) const {
+    const auto& suffixes = suffixArray.getSuffixes();
+    const auto& lcp = suffixArray.getLcp();
+    size_t n = suffixes.size();
+    if (n < 2) return;
+
+    const int EMPTY = -1;
+    const int DIVERSE = -2;
+    auto combine = [&](int a, int b) {
+        if (a == EMPTY) return b;
+        if (b == EMPTY) return a;
+        return a == b ? a : DIVERSE;
+    };
+    auto leftOf = [&](size_t rank) {
+        uint32_t position = suffixes[rank];
+        return position == 0 ? DIVERSE : static_cast<int>(static_cast<unsigned char>(text[position - 1]));
+    };
+
+    struct Interval {
+        size_t lcp;
+        size_t lb;
+        int left;
+    };
+    std::vector<Interval> stack = {{0, 0, EMPTY}};
+    std::vector<uint32_t> scratch;
+
+    for (size_t i = 1; i <= n; ++i) {
+        size_t current = (i < n) ? lcp[i] : 0;
+        int leafLeft = leftOf(i - 1);
+
+        if (current > stack.back().lcp) {
+            stack.push_back({current, i - 1, leafLeft});
+            continue;
+        }
+
+        stack.back().left = combine(stack.back().left, leafLeft);
+        size_t lb = i - 1;
+        int childLeft = EMPTY;
+
+        while (current < stack.back().lcp) {
+            Interval node = stack.back();
+            stack.pop_back();
+            lb = node.lb;
+
+            if (node.lcp >= minLength && node.left == DIVERSE) {
+                scratch.assign(suffixes.begin() + node.lb, suffixes.begin() + i);
+                std::sort(scratch.begin(), scratch.end());
+                if (!visit({node.lcp, scratch.data(), scratch.size()})) {
+                    return;
+                }
+            }
+
+            if (current <= stack.back().lcp) {
+                stack.back().left = combine(stack.back().left, node.left);
+            } else {
+                childLeft = node.left;
+            }
+        }
+
+        if (current > stack.back().lcp) {
+            stack.push_back({current, lb, childLeft});
+        }
+    }
+}
+
 KasiskiResult PatternFinder::performKasiskiExamination(size_t minLength) const {
     KasiskiResult result;
     std::map<int, int> spacingFrequencies;
@@ -76,6 +193,224 @@ KasiskiResult PatternFinder::performKasiskiExamination(size_t minLength) const {
     return result;
 }
 
+// Kasiski votes are weighted by repeat length and taken only between
+// consecutive occurrences (every other spacing is a sum of those), then
+// combined with per-period IoC and autocorrelation. Multiples of the true
+// period score well on IoC but only get about half the Kasiski votes, and
+// divisors get the votes but not the IoC, so the true length wins.
+std::vector<KeyLengthCandidate> PatternFinder::rankKeyLengths(
+    size_t maxKeyLength, size_t minLength, size_t topN) const {
+    std::vector<KeyLengthCandidate> candidates;
+    if (maxKeyLength < 2 || text.length() < 4) {
+        return candidates;
+    }
+    maxKeyLength = std::min(maxKeyLength, text.length() / 2);
+
+    double totalWeight = 0.0;
+    auto votes = weightedSpacingVotes(maxKeyLength, minLength, totalWeight);
+    auto coincidences = computeCoincidenceCounts(maxKeyLength);
+
+    for (size_t length = 2; length <= maxKeyLength; ++length) {
+        KeyLengthCandidate candidate;
+        candidate.length = length;
+        candidate.kasiskiScore = totalWeight > 0 ? votes[length] / totalWeight : 0.0;
+        candidate.iocScore = scaleCoincidence(averageColumnIoC(length));
+        candidate.autocorrelationScore = scaleCoincidence(
+            static_cast<double>(coincidences[length]) / (text.length() - length));
+        candidate.confidence = 0.4 * candidate.kasiskiScore +
+                               0.35 * candidate.iocScore +
+                               0.25 * candidate.autocorrelationScore;
+        candidates.push_back(candidate);
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+              [](const KeyLengthCandidate& a, const KeyLengthCandidate& b) {
+                  return a.confidence > b.confidence;
+              });
+
+    if (topN > 0 && candidates.size() > topN) {
+        candidates.resize(topN);
+    }
+    return candidates;
+}
+
+// Maximal repeats are split across pool tasks, each with its own dense vote array
+std::vector<double> PatternFinder::weightedSpacingVotes(
+    size_t maxKeyLength, size_t minLength, double& totalWeight) const {
+    std::vector<std::vector<uint32_t>> groups;
+    std::vector<size_t> lengths;
+    forEachMaximalRepeat(minLength, [&](const RepeatView& repeat) {
+        groups.emplace_back(repeat.positions, repeat.positions + repeat.occurrences);
+        lengths.push_back(repeat.length);
+        return true;
+    });
+
+    ThreadPool& pool = ThreadPool::global();
+    size_t partitions = std::min(pool.size(), std::max<size_t>(1, groups.size() / 256));
+
+    std::vector<std::vector<double>> partialVotes(partitions, std::vector<double>(maxKeyLength + 1, 0.0));
+    std::vector<double> partialWeights(partitions, 0.0);
+
+    pool.parallelFor(partitions, 1, [&](size_t first, size_t last) {
+        for (size_t t = first; t < last; ++t) {
+            auto& local = partialVotes[t];
+            for (size_t g = t; g < groups.size(); g += partitions) {
+                double weight = static_cast<double>(lengths[g]);
+                const auto& positions = groups[g];
+                for (size_t k = 1; k < positions.size(); ++k) {
+                    size_t spacing = positions[k] - positions[k - 1];
+                    partialWeights[t] += weight;
+                    for (size_t length = 2; length <= maxKeyLength; ++length) {
+                        if (spacing % length == 0) {
+                            local[length] += weight;
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<double> votes(maxKeyLength + 1, 0.0);
+    totalWeight = 0.0;
+    for (size_t t = 0; t < partitions; ++t) {
+        totalWeight += partialWeights[t];
+        for (size_t length = 0; length <= maxKeyLength; ++length) {
+            votes[length] += partialVotes[t][length];
+        }
+    }
+    return votes;
+}
+
+double PatternFinder::averageColumnIoC(size_t period) const {
+    std::vector<std::array<uint32_t, 26>> columns(period);
+    for (auto& column : columns) column.fill(0);
+    for (size_t i = 0; i < text.length(); ++i) {
+        columns[i % period][text[i] - 'A']++;
+    }
+
+    double total = 0.0;
+    size_t usable = 0;
+    for (const auto& column : columns) {
+        uint64_t size = 0, pairs = 0;
+        for (uint32_t count : column) {
+            size += count;
+            pairs += static_cast<uint64_t>(count) * (count > 0 ? count - 1 : 0);
+        }
+        if (size > 1) {
+            total += static_cast<double>(pairs) / (static_cast<double>(size) * (size - 1));
+            usable++;
+        }
+    }
+    return usable > 0 ? total / usable : 0.0;
+}
+
+// Shifts are spread over the shared pool once the text is long enough for
+// the per-shift work to outweigh scheduling.
+std::vector<size_t> PatternFinder::computeCoincidenceCounts(size_t maxShift) const {
+    std::vector<size_t> counts(maxShift + 1, 0);
+    if (maxShift == 0) return counts;
+
+    if (text.length() * maxShift < (size_t(1) << 24)) {
+        for (size_t shift = 1; shift <= maxShift; ++shift) {
+            counts[shift] = countCoincidences(shift);
+        }
+        return counts;
+    }
+
+    ThreadPool::global().parallelFor(maxShift, 1, [this, &counts](size_t first, size_t last) {
+        for (size_t shift = first + 1; shift <= last; ++shift) {
+            counts[shift] = countCoincidences(shift);
+        }
+    });
+    return counts;
+}
+
+// A period p shows up as high coincidence at p and at each of its multiples
+// and only there, so each candidate is scored by the contrast between its
+// multiples and every other shift. Multiples of the true period lose because
+// the true period's own shifts count against them. confidence is the contrast
+// on the IoC scale; the ranking also accounts for how many shifts support it.
+std::vector<KeyLengthCandidate> PatternFinder::estimatePeriodByAutocorrelation(
+    size_t maxShift, size_t topN) const {
+    std::vector<KeyLengthCandidate> candidates;
+    if (text.length() < 4) return candidates;
+    maxShift = std::min(maxShift, text.length() / 2);
+    if (maxShift < 2) return candidates;
+
+    auto counts = computeCoincidenceCounts(maxShift);
+    std::vector<double> rates(maxShift + 1, 0.0);
+    double rateSum = 0.0;
+    for (size_t shift = 1; shift <= maxShift; ++shift) {
+        rates[shift] = static_cast<double>(counts[shift]) / (text.length() - shift);
+        rateSum += rates[shift];
+    }
+
+    std::vector<double> contrasts;
+    for (size_t period = 2; period <= maxShift; ++period) {
+        double onPeriod = 0.0;
+        size_t multiples = 0;
+        for (size_t shift = period; shift <= maxShift; shift += period) {
+            onPeriod += rates[shift];
+            multiples++;
+        }
+
+        double offPeriod = rateSum - onPeriod;
+        size_t others = maxShift - multiples;
+        double contrast = onPeriod / multiples - (others > 0 ? offPeriod / others : RANDOM_IOC);
+        contrasts.push_back(contrast);
+        candidates.push_back({period, 0.0, 0.0, 0.0, scaleCoincidence(rates[period])});
+    }
+
+    // A single shift is a noisy sample; weight the contrast by how many
+    // shifts back it so the true period beats its lone large multiples.
+    std::vector<double> evidence(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        evidence[i] = contrasts[i] * std::sqrt(static_cast<double>(maxShift / candidates[i].length));
+    }
+
+    std::vector<size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+              [&evidence](size_t a, size_t b) { return evidence[a] > evidence[b]; });
+
+    std::vector<KeyLengthCandidate> ranked;
+    for (size_t index : order) {
+        KeyLengthCandidate candidate = candidates[index];
+        candidate.confidence = std::max(0.0, std::min(1.0, contrasts[index] / (ENGLISH_IOC - RANDOM_IOC)));
+        ranked.push_back(candidate);
+    }
+    candidates = std::move(ranked);
+
+    if (topN > 0 && candidates.size() > topN) {
+        candidates.resize(topN);
+    }
+    return candidates;
+}
+
+// Byte-wise compare of the text against itself at the given shift, 16 bytes
+// per step, with the match mask popcounted.
+size_t PatternFinder::countCoincidences(size_t shift) const {
+    if (shift >= text.length()) return 0;
+    const char* data = text.data();
+    size_t limit = text.length() - shift;
+    size_t matches = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= limit; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + shift));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+        matches += __builtin_popcount(mask);
+    }
+#endif
+
+    for (; i < limit; ++i) {
+        matches += (data[i] == data[i + shift]);
+    }
+    return matches;
+}
+
 std::vector<std::string> PatternFinder::findAnagrams() const {
     std::vector<std::string> anagrams;
     std::map<std::string, std::vector<std::string>> sortedGroups;
@@ -101,22 +436,18 @@ std::vector<std::string> PatternFinder::findAnagrams() const {
 }
 
 std::map<char, std::vector<size_t>> PatternFinder::findLetterSpacing() const {
+    std::array<std::vector<size_t>, 26> buckets;
+    for (size_t i = 0; i < text.length(); ++i) {
+        buckets[text[i] - 'A'].push_back(i);
+    }
+
     std::map<char, std::vector<size_t>> spacings;
-    
-    for (char c = 'A'; c <= 'Z'; ++c) {
-        std::vector<size_t> positions;
-        size_t pos = text.find(c);
-        
-        while (pos != std::string::npos) {
-            positions.push_back(pos);
-            pos = text.find(c, pos + 1);
-        }
-        
-        if (!positions.empty()) {
-            spacings[c] = positions;
+    for (size_t letter = 0; letter < 26; ++letter) {
+        if (!buckets[letter].empty()) {
+            spacings[static_cast<char>('A' + letter)] = std::move(buckets[letter]);
         }
     }
-    
+
     return spacings;
 }
 
@@ -182,6 +513,30 @@ std::vector<size_t> PatternFinder::findAllOccurrences(const std::string& pattern
     return positions;
 }
 
+std::map<std::string, std::vector<size_t>> PatternFinder::findAllOccurrences(
+    const std::vector<std::string>& patterns) const {
+    std::map<std::string, std::vector<size_t>> occurrences;
+    AhoCorasick automaton;
+    for (const auto& pattern : patterns) {
+        std::string normalized = normalizeText(pattern);
+        if (normalized.empty() || occurrences.count(normalized)) continue;
+        occurrences[normalized];
+        automaton.addPattern(normalized);
+    }
+    automaton.build();
+
+    // Look each pattern's slot up once so the scan itself only appends
+    std::vector<std::vector<size_t>*> slots(automaton.patternCount());
+    for (size_t id = 0; id < slots.size(); ++id) {
+        slots[id] = &occurrences[automaton.getPattern(id)];
+    }
+    automaton.scan(text.data(), text.length(), [&slots](size_t id, size_t start) {
+        slots[id]->push_back(start);
+    });
+
+    return occurrences;
+}
+
 std::vector<int> PatternFinder::calculateSpacings(const std::vector<size_t>& positions) const {
     std::vector<int> spacings;
     
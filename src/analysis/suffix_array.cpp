@@ -0,0 +1,170 @@
+#include "../../include/analysis/suffix_array.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+SuffixArray::SuffixArray() {
+}
+
+SuffixArray::SuffixArray(const std::string& text) {
+    if (text.length() >= static_cast<size_t>(INT32_MAX)) {
+        throw std::length_error("Text too long for suffix array");
+    }
+
+    std::vector<int> symbols(text.length());
+    for (size_t i = 0; i < text.length(); ++i) {
+        symbols[i] = static_cast<unsigned char>(text[i]);
+    }
+
+    auto sa = buildSuffixArray(symbols, 255);
+    suffixes.assign(sa.begin(), sa.end());
+    buildLcp(text);
+}
+
+const std::vector<uint32_t>& SuffixArray::getSuffixes() const {
+    return suffixes;
+}
+
+const std::vector<uint32_t>& SuffixArray::getLcp() const {
+    return lcp;
+}
+
+size_t SuffixArray::size() const {
+    return suffixes.size();
+}
+
+// SA-IS (Nong, Zhang & Chan): classify suffixes as S/L type, sort the LMS
+// substrings by induced sorting, recurse on their names if any are equal,
+// then induce the full order from the sorted LMS suffixes.
+std::vector<int> SuffixArray::buildSuffixArray(const std::vector<int>& symbols, int upper) {
+    const std::vector<int>& s = symbols;
+    int n = static_cast<int>(s.size());
+    if (n == 0) return {};
+    if (n == 1) return {0};
+    if (n == 2) {
+        if (s[0] < s[1]) return {0, 1};
+        return {1, 0};
+    }
+
+    std::vector<int> sa(n);
+    std::vector<bool> isS(n, false);
+    for (int i = n - 2; i >= 0; --i) {
+        isS[i] = (s[i] == s[i + 1]) ? isS[i + 1] : (s[i] < s[i + 1]);
+    }
+
+    // Bucket starts for S-type (sumS) and L-type (sumL) suffixes
+    std::vector<int> sumL(upper + 1, 0), sumS(upper + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        if (!isS[i]) {
+            sumS[s[i]]++;
+        } else {
+            sumL[s[i] + 1]++;
+        }
+    }
+    for (int i = 0; i <= upper; ++i) {
+        sumS[i] += sumL[i];
+        if (i < upper) sumL[i + 1] += sumS[i];
+    }
+
+    auto induce = [&](const std::vector<int>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+        std::vector<int> buf(upper + 1);
+
+        std::copy(sumS.begin(), sumS.end(), buf.begin());
+        for (int d : lms) {
+            if (d == n) continue;
+            sa[buf[s[d]]++] = d;
+        }
+
+        std::copy(sumL.begin(), sumL.end(), buf.begin());
+        sa[buf[s[n - 1]]++] = n - 1;
+        for (int i = 0; i < n; ++i) {
+            int v = sa[i];
+            if (v >= 1 && !isS[v - 1]) {
+                sa[buf[s[v - 1]]++] = v - 1;
+            }
+        }
+
+        std::copy(sumL.begin(), sumL.end(), buf.begin());
+        for (int i = n - 1; i >= 0; --i) {
+            int v = sa[i];
+            if (v >= 1 && isS[v - 1]) {
+                sa[--buf[s[v - 1] + 1]] = v - 1;
+            }
+        }
+    };
+
+    std::vector<int> lmsMap(n + 1, -1);
+    int m = 0;
+    for (int i = 1; i < n; ++i) {
+        if (!isS[i - 1] && isS[i]) lmsMap[i] = m++;
+    }
+    std::vector<int> lms;
+    lms.reserve(m);
+    for (int i = 1; i < n; ++i) {
+        if (!isS[i - 1] && isS[i]) lms.push_back(i);
+    }
+
+    induce(lms);
+
+    if (m) {
+        std::vector<int> sortedLms;
+        sortedLms.reserve(m);
+        for (int v : sa) {
+            if (lmsMap[v] != -1) sortedLms.push_back(v);
+        }
+
+        // Name the LMS substrings; equal substrings share a name
+        std::vector<int> reduced(m);
+        int reducedUpper = 0;
+        reduced[lmsMap[sortedLms[0]]] = 0;
+        for (int i = 1; i < m; ++i) {
+            int l = sortedLms[i - 1], r = sortedLms[i];
+            int endL = (lmsMap[l] + 1 < m) ? lms[lmsMap[l] + 1] : n;
+            int endR = (lmsMap[r] + 1 < m) ? lms[lmsMap[r] + 1] : n;
+            bool same = true;
+            if (endL - l != endR - r) {
+                same = false;
+            } else {
+                while (l < endL) {
+                    if (s[l] != s[r]) break;
+                    ++l;
+                    ++r;
+                }
+                if (l == n || s[l] != s[r]) same = false;
+            }
+            if (!same) reducedUpper++;
+            reduced[lmsMap[sortedLms[i]]] = reducedUpper;
+        }
+
+        auto reducedSa = buildSuffixArray(reduced, reducedUpper);
+        for (int i = 0; i < m; ++i) {
+            sortedLms[i] = lms[reducedSa[i]];
+        }
+        induce(sortedLms);
+    }
+
+    return sa;
+}
+
+void SuffixArray::buildLcp(const std::string& text) {
+    size_t n = suffixes.size();
+    lcp.assign(n, 0);
+    std::vector<uint32_t> rank(n);
+    for (size_t i = 0; i < n; ++i) {
+        rank[suffixes[i]] = static_cast<uint32_t>(i);
+    }
+
+    size_t h = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (rank[i] == 0) {
+            h = 0;
+            continue;
+        }
+        size_t j = suffixes[rank[i] - 1];
+        while (i + h < n && j + h < n && text[i + h] == text[j + h]) {
+            ++h;
+        }
+        lcp[rank[i]] = static_cast<uint32_t>(h);
+        if (h > 0) --h;
+    }
+}
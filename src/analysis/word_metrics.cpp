@@ -1,9 +1,44 @@
 #include "../../include/analysis/word_metrics.hpp"
-#include <sstream>
 #include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <numeric>
+#include <unordered_map>
+#include <cctype>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Vowel flags for every byte value, so classification needs no tolower
+struct VowelTable {
+    uint8_t isVowel[256];
+    constexpr VowelTable() : isVowel() {
+        const char* vowels = "aeiouyAEIOUY";
+        for (size_t i = 0; vowels[i] != '\0'; ++i) {
+            isVowel[static_cast<unsigned char>(vowels[i])] = 1;
+        }
+    }
+};
+constexpr VowelTable VOWELS;
+
+#if defined(__SSE2__)
+// Bit i set if data[i] is a vowel. Setting 0x20 folds upper to lower case,
+// and only an uppercase vowel folds onto a lowercase one.
+unsigned vowelMask16(const char* data) {
+    __m128i folded = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+                                  _mm_set1_epi8(0x20));
+    __m128i hits = _mm_cmpeq_epi8(folded, _mm_set1_epi8('a'));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(folded, _mm_set1_epi8('e')));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(folded, _mm_set1_epi8('i')));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(folded, _mm_set1_epi8('o')));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(folded, _mm_set1_epi8('u')));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(folded, _mm_set1_epi8('y')));
+    return static_cast<unsigned>(_mm_movemask_epi8(hits));
+}
+#endif
+}
 
 WordMetrics::WordMetrics() {
     initializeDefaultPatterns();
@@ -13,94 +48,63 @@ WordMetrics::WordMetrics(const std::string& languageConfig) {
     loadLanguageConfig(languageConfig);
 }
 
+// One tokenization feeds every metric
 WordMetricsResult WordMetrics::analyzeText(const std::string& text) const {
     WordMetricsResult result;
-    auto words = tokenizeText(text);
+    InternedText interned = internTokens(text);
     
-    result.averageWordLength = calculateAverageWordLength(text);
-    result.lexicalDiversity = calculateLexicalDiversity(text);
+    result.averageWordLength = averageWordLength(interned);
+    result.lexicalDiversity = typeTokenRatio(interned);
     result.syllableComplexity = 0.0;
-    result.uniqueWordCount = std::set<std::string>(words.begin(), words.end()).size();
-    result.typeTokenRatio = calculateTypeTokenRatio(text);
-    result.mostComplexWords = getMostComplexWords(text, 10);
-    result.wordLengthDistribution = getWordLengthDistribution(text);
-    result.readabilityScore = calculateReadabilityScore(text);
-    result.vocabularyRichness = calculateVocabularyRichness(text);
+    result.uniqueWordCount = interned.words.size();
+    result.typeTokenRatio = result.lexicalDiversity;
+    result.mostComplexWords = mostComplexWords(interned, 10);
+    result.wordLengthDistribution = wordLengthDistribution(interned);
+    result.readabilityScore = readabilityScore(interned);
+    result.vocabularyRichness = vocabularyRichness(interned);
     
     return result;
 }
 
 WordComplexityMetrics WordMetrics::analyzeWord(const std::string& word) const {
+    MorphemeScan scan = scanMorphemes(normalizeWord(word));
     WordComplexityMetrics metrics;
     metrics.syllableCount = countSyllables(word);
-    metrics.morphemes = extractMorphemes(word);
-    metrics.morphemeCount = metrics.morphemes.size();
-    metrics.isCompound = isCompoundWord(word);
-    metrics.complexityScore = calculateWordComplexity(word);
+    metrics.morphemeCount = scan.morphemes.size();
+    metrics.isCompound = scan.components.size() > 1;
+    metrics.complexityScore = complexityFrom(metrics.syllableCount, scan);
+    metrics.morphemes = std::move(scan.morphemes);
     return metrics;
 }
 
 double WordMetrics::calculateAverageWordLength(const std::string& text) const {
-    auto words = tokenizeText(text);
-    if (words.empty()) return 0.0;
-    
-    double totalLength = std::accumulate(words.begin(), words.end(), 0.0,
-        [](double sum, const std::string& word) { return sum + word.length(); });
-    return totalLength / words.size();
+    return averageWordLength(internTokens(text));
 }
 
 double WordMetrics::calculateLexicalDiversity(const std::string& text) const {
-    auto words = tokenizeText(text);
-    std::set<std::string> uniqueWords;
-    for (const auto& word : words) {
-        uniqueWords.insert(normalizeWord(word));
-    }
-    return static_cast<double>(uniqueWords.size()) / words.size();
+    return typeTokenRatio(internTokens(text));
 }
 
 double WordMetrics::calculateVocabularyRichness(const std::string& text) const {
-    auto freqDist = getWordFrequencyDistribution(text);
-    double totalWords = 0;
-    for (const auto& pair : freqDist) {
-        totalWords += pair.second;
-    }
-    return std::log(freqDist.size()) / std::log(totalWords);
+    return vocabularyRichness(internTokens(text));
 }
 
 double WordMetrics::calculateReadabilityScore(const std::string& text) const {
-    auto words = tokenizeText(text);
-    double avgSyllables = 0.0;
-    for (const auto& word : words) {
-        avgSyllables += countSyllables(word);
-    }
-    avgSyllables /= words.size();
-    
-    return 206.835 - 1.015 * (words.size()) - 84.6 * avgSyllables;
+    return readabilityScore(internTokens(text));
 }
 
 std::vector<std::string> WordMetrics::getMostComplexWords(const std::string& text, size_t n) const {
-    auto words = tokenizeText(text);
-    std::vector<std::pair<std::string, double>> wordComplexities;
-    
-    for (const auto& word : words) {
-        wordComplexities.emplace_back(word, calculateWordComplexity(word));
-    }
-    
-    std::sort(wordComplexities.begin(), wordComplexities.end(),
-        [](const auto& a, const auto& b) { return a.second > b.second; });
-    
-    std::vector<std::string> result;
-    for (size_t i = 0; i < std::min(n, wordComplexities.size()); ++i) {
-        result.push_back(wordComplexities[i].first);
-    }
-    return result;
+    return mostComplexWords(internTokens(text), n);
 }
 
 std::map<std::string, size_t> WordMetrics::getSyllableCounts(
     const std::vector<std::string>& words) const {
     std::map<std::string, size_t> counts;
     for (const auto& word : words) {
-        counts[word] = countSyllables(word);
+        auto inserted = counts.emplace(word, 0);
+        if (inserted.second) {
+            inserted.first->second = countSyllables(word);
+        }
     }
     return counts;
 }
@@ -109,48 +113,36 @@ std::vector<std::string> WordMetrics::extractMorphemes(const std::string& word)
     return findMorphemePatterns(word);
 }
 
+std::vector<std::string> WordMetrics::findAffixes(const std::string& word) const {
+    return scanMorphemes(normalizeWord(word)).affixes;
+}
+
 std::map<size_t, size_t> WordMetrics::getWordLengthDistribution(const std::string& text) const {
-    auto words = tokenizeText(text);
-    std::map<size_t, size_t> distribution;
-    for (const auto& word : words) {
-        distribution[word.length()]++;
-    }
-    return distribution;
+    return wordLengthDistribution(internTokens(text));
 }
 
 std::map<std::string, size_t> WordMetrics::getWordFrequencyDistribution(
     const std::string& text) const {
-    auto words = tokenizeText(text);
-    std::map<std::string, size_t> distribution;
-    for (const auto& word : words) {
-        distribution[normalizeWord(word)]++;
-    }
-    return distribution;
+    return wordFrequencyDistribution(internTokens(text));
 }
 
 double WordMetrics::calculateTypeTokenRatio(const std::string& text) const {
-    auto words = tokenizeText(text);
-    std::set<std::string> uniqueWords;
-    for (const auto& word : words) {
-        uniqueWords.insert(normalizeWord(word));
-    }
-    return static_cast<double>(uniqueWords.size()) / words.size();
+    return typeTokenRatio(internTokens(text));
 }
 
 double WordMetrics::calculateHapaxLegomenaRatio(const std::string& text) const {
-    auto freqDist = getWordFrequencyDistribution(text);
-    size_t hapaxCount = std::count_if(freqDist.begin(), freqDist.end(),
-        [](const auto& pair) { return pair.second == 1; });
-    return static_cast<double>(hapaxCount) / freqDist.size();
+    InternedText interned = internTokens(text);
+    size_t hapaxCount = std::count(interned.normalizedCounts.begin(), interned.normalizedCounts.end(), size_t(1));
+    return static_cast<double>(hapaxCount) / interned.normalizedCounts.size();
 }
 
 double WordMetrics::calculateYuleK(const std::string& text) const {
-    auto freqDist = getWordFrequencyDistribution(text);
+    InternedText interned = internTokens(text);
     double M1 = 0.0, M2 = 0.0;
     
-    for (const auto& pair : freqDist) {
-        M1 += pair.second;
-        M2 += pair.second * pair.second;
+    for (size_t count : interned.normalizedCounts) {
+        M1 += count;
+        M2 += count * count;
     }
     
     return 10000 * (M2 - M1) / (M1 * M1);
@@ -161,53 +153,167 @@ bool WordMetrics::isCompoundWord(const std::string& word) const {
 }
 
 std::vector<std::string> WordMetrics::decomposeCompoundWord(const std::string& word) const {
-    std::vector<std::string> components;
-    std::string normalized = normalizeWord(word);
-    
-    for (const auto& pattern : morphemePatterns) {
-        size_t pos = 0;
-        while ((pos = normalized.find(pattern.first, pos)) != std::string::npos) {
-            components.push_back(pattern.first);
-            pos += pattern.first.length();
-        }
-    }
-    
-    return components;
+    return scanMorphemes(normalizeWord(word)).components;
 }
 
 size_t WordMetrics::countSyllables(const std::string& word) const {
+    return syllablesIn(word);
+}
+
+// Counts runs of vowels. Long tokens are classified 16 bytes at a time: a run
+// starts wherever a vowel bit is set and the bit before it (carried across
+// blocks) is clear.
+size_t WordMetrics::syllablesIn(std::string_view word) const {
     size_t count = 0;
-    bool prevIsVowel = false;
-    
-    for (char c : word) {
-        bool currIsVowel = isVowel(c);
-        if (currIsVowel && !prevIsVowel) {
-            count++;
-        }
+    unsigned prevIsVowel = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= word.length(); i += 16) {
+        unsigned mask = vowelMask16(word.data() + i);
+        unsigned starts = mask & ~((mask << 1) | prevIsVowel);
+        count += __builtin_popcount(starts);
+        prevIsVowel = (mask >> 15) & 1;
+    }
+#endif
+
+    for (; i < word.length(); ++i) {
+        unsigned currIsVowel = VOWELS.isVowel[static_cast<unsigned char>(word[i])];
+        count += currIsVowel & ~prevIsVowel;
         prevIsVowel = currIsVowel;
     }
     
     return std::max(count, size_t(1));
 }
 
+// Syllable counts of the distinct tokens, computed on first use and then
+// shared by every metric over the same analysis
+const std::vector<uint32_t>& WordMetrics::syllableCounts(const InternedText& interned) const {
+    if (interned.syllables.size() != interned.words.size()) {
+        interned.syllables.resize(interned.words.size());
+        for (size_t id = 0; id < interned.words.size(); ++id) {
+            interned.syllables[id] = static_cast<uint32_t>(syllablesIn(interned.words[id]));
+        }
+    }
+    return interned.syllables;
+}
+
 // Private helper methods implementation
 bool WordMetrics::isVowel(char c) const {
-    c = std::tolower(c);
-    return (c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y');
+    return VOWELS.isVowel[static_cast<unsigned char>(c)];
 }
 
 bool WordMetrics::isConsonant(char c) const {
     return std::isalpha(c) && !isVowel(c);
 }
 
-std::vector<std::string> WordMetrics::tokenizeText(const std::string& text) const {
-    std::vector<std::string> tokens;
-    std::istringstream iss(text);
-    std::string token;
-    while (iss >> token) {
-        tokens.push_back(token);
+// Splits on the same whitespace as operator>> and interns each token. Only
+// the first occurrence of a token is normalized.
+WordMetrics::InternedText WordMetrics::internTokens(const std::string& text) const {
+    InternedText interned;
+    std::unordered_map<std::string_view, uint32_t> wordIds;
+    std::unordered_map<std::string, uint32_t> normalizedIds;
+
+    size_t i = 0, n = text.length();
+    while (i < n) {
+        while (i < n && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+        size_t start = i;
+        while (i < n && !std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+        if (start == i) break;
+
+        std::string_view word(text.data() + start, i - start);
+        interned.tokenCount++;
+        interned.totalLength += word.length();
+
+        auto inserted = wordIds.emplace(word, static_cast<uint32_t>(interned.words.size()));
+        uint32_t id = inserted.first->second;
+        if (inserted.second) {
+            std::string normalized = normalizeWord(std::string(word));
+            auto normal = normalizedIds.emplace(normalized, static_cast<uint32_t>(interned.normalizedWords.size()));
+            if (normal.second) {
+                interned.normalizedWords.push_back(std::move(normalized));
+                interned.normalizedCounts.push_back(0);
+            }
+            interned.words.push_back(word);
+            interned.counts.push_back(0);
+            interned.normalizedIds.push_back(normal.first->second);
+        }
+        interned.counts[id]++;
+        interned.normalizedCounts[interned.normalizedIds[id]]++;
+    }
+    return interned;
+}
+
+double WordMetrics::averageWordLength(const InternedText& interned) const {
+    if (interned.tokenCount == 0) return 0.0;
+    return static_cast<double>(interned.totalLength) / interned.tokenCount;
+}
+
+double WordMetrics::typeTokenRatio(const InternedText& interned) const {
+    return static_cast<double>(interned.normalizedWords.size()) / interned.tokenCount;
+}
+
+double WordMetrics::vocabularyRichness(const InternedText& interned) const {
+    return std::log(interned.normalizedWords.size()) / std::log(interned.tokenCount);
+}
+
+double WordMetrics::readabilityScore(const InternedText& interned) const {
+    const std::vector<uint32_t>& syllables = syllableCounts(interned);
+    double avgSyllables = 0.0;
+    for (size_t id = 0; id < interned.words.size(); ++id) {
+        avgSyllables += static_cast<double>(syllables[id]) * interned.counts[id];
     }
-    return tokens;
+    avgSyllables /= interned.tokenCount;
+    
+    return 206.835 - 1.015 * (interned.tokenCount) - 84.6 * avgSyllables;
+}
+
+// Complexity is computed once per distinct token; each token then fills as
+// many of the top n places as it has occurrences.
+std::vector<std::string> WordMetrics::mostComplexWords(const InternedText& interned, size_t n) const {
+    // Morphemes depend only on the normalized form, so each normalized word
+    // is scanned once and shared by every spelling that maps to it
+    std::vector<MorphemeScan> scans;
+    scans.reserve(interned.normalizedWords.size());
+    for (const auto& normalized : interned.normalizedWords) {
+        scans.push_back(scanMorphemes(normalized));
+    }
+
+    const std::vector<uint32_t>& syllables = syllableCounts(interned);
+    std::vector<std::pair<uint32_t, double>> wordComplexities;
+    wordComplexities.reserve(interned.words.size());
+    for (size_t id = 0; id < interned.words.size(); ++id) {
+        wordComplexities.emplace_back(static_cast<uint32_t>(id),
+            complexityFrom(syllables[id], scans[interned.normalizedIds[id]]));
+    }
+    
+    std::stable_sort(wordComplexities.begin(), wordComplexities.end(),
+        [](const auto& a, const auto& b) { return a.second > b.second; });
+    
+    std::vector<std::string> result;
+    for (const auto& entry : wordComplexities) {
+        for (size_t k = 0; k < interned.counts[entry.first] && result.size() < n; ++k) {
+            result.emplace_back(interned.words[entry.first]);
+        }
+        if (result.size() >= n) break;
+    }
+    return result;
+}
+
+std::map<size_t, size_t> WordMetrics::wordLengthDistribution(const InternedText& interned) const {
+    std::map<size_t, size_t> distribution;
+    for (size_t id = 0; id < interned.words.size(); ++id) {
+        distribution[interned.words[id].length()] += interned.counts[id];
+    }
+    return distribution;
+}
+
+std::map<std::string, size_t> WordMetrics::wordFrequencyDistribution(const InternedText& interned) const {
+    std::map<std::string, size_t> distribution;
+    for (size_t id = 0; id < interned.normalizedWords.size(); ++id) {
+        distribution[interned.normalizedWords[id]] = interned.normalizedCounts[id];
+    }
+    return distribution;
 }
 
 std::string WordMetrics::normalizeWord(const std::string& word) const {
@@ -243,13 +349,20 @@ void WordMetrics::initializeDefaultPatterns() {
         {"vowel_sequence", 1},
         {"silent_e", 0}
     };
+
+    compileMorphemeMatcher();
 }
 
+// Syllables on the raw word; morphemes and compound parts from one scan
 double WordMetrics::calculateWordComplexity(const std::string& word) const {
+    return complexityFrom(countSyllables(word), scanMorphemes(normalizeWord(word)));
+}
+
+double WordMetrics::complexityFrom(size_t syllables, const MorphemeScan& scan) const {
     double complexity = 0.0;
-    complexity += countSyllables(word) * 0.4;
-    complexity += countMorphemes(word) * 0.3;
-    complexity += (isCompoundWord(word) ? 0.3 : 0.0);
+    complexity += syllables * 0.4;
+    complexity += scan.morphemes.size() * 0.3;
+    complexity += (scan.components.size() > 1 ? 0.3 : 0.0);
     return complexity;
 }
 
@@ -258,18 +371,72 @@ size_t WordMetrics::countMorphemes(const std::string& word) const {
 }
 
 std::vector<std::string> WordMetrics::findMorphemePatterns(const std::string& word) const {
-    std::vector<std::string> patterns;
-    std::string normalized = normalizeWord(word);
-    
+    return scanMorphemes(normalizeWord(word)).morphemes;
+}
+
+// Pattern ids are assigned in configuration order, and each role keeps a
+// slot index so results come out in the order the per-pattern searches used.
+void WordMetrics::compileMorphemeMatcher() {
+    morphemeMatcher = AhoCorasick();
+    matchTargets.clear();
+    morphemeSlots.clear();
+    componentSlots.clear();
+    affixSlots.clear();
+
+    auto add = [this](const std::string& pattern, MatchRole role, std::vector<std::string>& slots) {
+        matchTargets.push_back({role, static_cast<uint32_t>(slots.size())});
+        slots.push_back(pattern);
+        morphemeMatcher.addPattern(pattern);
+    };
+
     for (const auto& pattern : morphemePatterns) {
         for (const auto& morpheme : pattern.second) {
-            if (normalized.find(morpheme) != std::string::npos) {
-                patterns.push_back(morpheme);
+            add(morpheme, MORPHEME_MATCH, morphemeSlots);
+        }
+    }
+    for (const auto& pattern : morphemePatterns) {
+        add(pattern.first, COMPONENT_MATCH, componentSlots);
+    }
+    for (const auto& affix : commonAffixes) {
+        add(affix, AFFIX_MATCH, affixSlots);
+    }
+    morphemeMatcher.build();
+}
+
+// Morphemes and affixes are reported once if present anywhere. Components
+// count non-overlapping occurrences, leftmost first, like repeated find().
+WordMetrics::MorphemeScan WordMetrics::scanMorphemes(const std::string& normalized) const {
+    std::vector<uint8_t> morphemeFound(morphemeSlots.size(), 0);
+    std::vector<uint8_t> affixFound(affixSlots.size(), 0);
+    std::vector<std::vector<size_t>> componentStarts(componentSlots.size());
+
+    morphemeMatcher.scan(normalized.data(), normalized.length(), [&](size_t id, size_t start) {
+        const MatchTarget& target = matchTargets[id];
+        switch (target.role) {
+            case MORPHEME_MATCH: morphemeFound[target.slot] = 1; break;
+            case AFFIX_MATCH: affixFound[target.slot] = 1; break;
+            case COMPONENT_MATCH: componentStarts[target.slot].push_back(start); break;
+        }
+    });
+
+    MorphemeScan scan;
+    for (size_t slot = 0; slot < morphemeSlots.size(); ++slot) {
+        if (morphemeFound[slot]) scan.morphemes.push_back(morphemeSlots[slot]);
+    }
+    for (size_t slot = 0; slot < componentSlots.size(); ++slot) {
+        size_t length = componentSlots[slot].length();
+        size_t nextFree = 0;
+        for (size_t start : componentStarts[slot]) {
+            if (start >= nextFree) {
+                scan.components.push_back(componentSlots[slot]);
+                nextFree = start + length;
             }
         }
     }
-    
-    return patterns;
+    for (size_t slot = 0; slot < affixSlots.size(); ++slot) {
+        if (affixFound[slot]) scan.affixes.push_back(affixSlots[slot]);
+    }
+    return scan;
 }
 
 double WordMetrics::calculateStandardDeviation(const std::vector<double>& values) const {
@@ -1,5 +1,6 @@
 #include "../../include/ciphers/affine.hpp"
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <cctype>
 #include <sstream>
 #include <algorithm>
@@ -22,6 +23,7 @@ int Affine::modInverse(int a, int m) const {
 
 // Encrypt text using Affine cipher with a key
 std::string Affine::encrypt() const {
+    FSCT_TRACE_SCOPE("Affine::encrypt");
     std::string result;
     for (char c : encryptedText) {
         if (isalpha(c)) {
@@ -36,6 +38,7 @@ std::string Affine::encrypt() const {
 
 // Decrypt text using Affine cipher with a key
 std::string Affine::decrypt() const {
+    FSCT_TRACE_SCOPE("Affine::decrypt");
     std::string result;
     int a_inv = modInverse(a, 26); // Modular inverse of 'a' under modulo 26
     if (a_inv == -1) {
@@ -56,6 +59,7 @@ std::string Affine::decrypt() const {
 
 // Suggest encryptions or decryptions based on dictionary matches
 void Affine::suggestDecryptions(int topN, const std::string& analysisMode, bool encryptMode) const {
+    FSCT_TRACE_SCOPE("Affine::suggestDecryptions");
     std::vector<DecryptionResult> results;
 
     for (int shift = 0; shift < 26; ++shift) {
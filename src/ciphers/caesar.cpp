@@ -1,5 +1,6 @@
 #include "../../include/ciphers/caesar.hpp"
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <cctype>
 #include <sstream>
 #include <algorithm>
@@ -11,6 +12,7 @@ Caesar::Caesar(const std::string& text, Dictionary* dict)
 
 // Decrypt text using Caesar cipher shift
 std::string Caesar::decrypt(int shift) const {
+    FSCT_TRACE_SCOPE("Caesar::decrypt");
     std::string result;
     for (char c : encryptedText) {
         if (isalpha(c)) {
@@ -25,6 +27,7 @@ std::string Caesar::decrypt(int shift) const {
 
 // encrypt text using Caesar cipher shift
 std::string Caesar::encrypt(int shift) const {
+    FSCT_TRACE_SCOPE("Caesar::encrypt");
     std::string result;
     for (char c : encryptedText) {
         if (isalpha(c)) {
@@ -39,6 +42,7 @@ std::string Caesar::encrypt(int shift) const {
 
 // Suggest decryptions based on dictionary matches
 void Caesar::suggestDecryptions(int topN, const std::string& analysisMode) const {
+    FSCT_TRACE_SCOPE("Caesar::suggestDecryptions");
     std::vector<DecryptionResult> results;
 
     for (int shift = 0; shift < 26; ++shift) {
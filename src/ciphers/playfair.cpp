@@ -1,5 +1,6 @@
 #include "../../include/ciphers/playfair.hpp"
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <cctype>
 #include <iostream>
 #include <sstream>
@@ -35,12 +36,13 @@ void Playfair::generateKeyMatrix() {
     }
 }
 
-// Clean the key by removing duplicates and non-alphabet characters
+// Clean the key by removing non-alphabet characters; 'j' shares the 'i' cell
 std::string Playfair::cleanKey(const std::string& inputKey) const {
     std::string cleaned;
     for (char c : inputKey) {
         if (isalpha(c)) {
-            cleaned += std::tolower(c);
+            char lower = std::tolower(c);
+            cleaned += lower == 'j' ? 'i' : lower;
         }
     }
     return cleaned;
@@ -48,6 +50,7 @@ std::string Playfair::cleanKey(const std::string& inputKey) const {
 
 // Encrypt text using Playfair cipher
 std::string Playfair::encrypt() const {
+    FSCT_TRACE_SCOPE("Playfair::encrypt");
     std::string result;
     std::string text = prepareTextForCipher(encryptedText);
 
@@ -55,7 +58,7 @@ std::string Playfair::encrypt() const {
         char first = text[i];
         char second = text[i + 1];
 
-        int row1, col1, row2, col2;
+        int row1 = 0, col1 = 0, row2 = 0, col2 = 0;
         findPosition(first, row1, col1);
         findPosition(second, row2, col2);
 
@@ -76,6 +79,7 @@ std::string Playfair::encrypt() const {
 
 // Decrypt text using Playfair cipher
 std::string Playfair::decrypt() const {
+    FSCT_TRACE_SCOPE("Playfair::decrypt");
     std::string result;
     std::string text = prepareTextForCipher(encryptedText);
 
@@ -83,7 +87,7 @@ std::string Playfair::decrypt() const {
         char first = text[i];
         char second = text[i + 1];
 
-        int row1, col1, row2, col2;
+        int row1 = 0, col1 = 0, row2 = 0, col2 = 0;
         findPosition(first, row1, col1);
         findPosition(second, row2, col2);
 
@@ -107,7 +111,8 @@ std::string Playfair::prepareTextForCipher(const std::string& inputText) const {
     std::string cleanedText;
     for (char c : inputText) {
         if (isalpha(c)) {
-            cleanedText += std::tolower(c);
+            char lower = std::tolower(c);
+            cleanedText += lower == 'j' ? 'i' : lower;
         }
     }
 
@@ -134,6 +139,7 @@ void Playfair::findPosition(char c, int& row, int& col) const {
 
 // Suggest decryptions based on dictionary matches
 void Playfair::suggestDecryptions(int topN, const std::string& analysisMode) const {
+    FSCT_TRACE_SCOPE("Playfair::suggestDecryptions");
     std::vector<DecryptionResult> results;
 
     for (int shift = 0; shift < 26; ++shift) {
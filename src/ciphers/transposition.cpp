@@ -1,5 +1,6 @@
 #include "../../include/ciphers/transposition.hpp"
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -11,6 +12,7 @@ Transposition::Transposition(const std::string& text, Dictionary* dict)
     : plaintext(text), dictionary(dict) {}
 
 std::string Transposition::encrypt(int key) const {
+    FSCT_TRACE_SCOPE("Transposition::encrypt");
     if (key <= 0) {
         throw std::invalid_argument("Key must be a positive integer.");
     }
@@ -44,6 +46,7 @@ std::string Transposition::encrypt(int key) const {
 }
 
 std::string Transposition::decrypt(int key) const {
+    FSCT_TRACE_SCOPE("Transposition::decrypt");
     if (key <= 0) {
         throw std::invalid_argument("Key must be a positive integer.");
     }
@@ -58,11 +61,10 @@ std::string Transposition::decrypt(int key) const {
 
     int currentChar = 0;
     // Fill the grid column by column with encrypted text
-    std::string encryptedText;
     for (int c = 0; c < numColumns; ++c) {
         for (int r = 0; r < rows; ++r) {
             if (currentChar < len) {
-                grid[r] += encryptedText[currentChar++];
+                grid[r] += plaintext[currentChar++];
             }
         }
     }
@@ -136,6 +138,7 @@ void Transposition::printEncryptedAndDecryptedText(const std::string& encrypted,
     std::cout << "Decrypted text:\n" << decrypted << std::endl;
 }
 void Transposition::suggestDecryptions(int topN, const std::string& analysisMode) const {
+    FSCT_TRACE_SCOPE("Transposition::suggestDecryptions");
     std::vector<DecryptionResult> results;
 
     for (int shift = 0; shift < 26; ++shift) {
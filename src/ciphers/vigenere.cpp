@@ -1,5 +1,6 @@
 #include "../../include/ciphers/vigenere.hpp"
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <cctype>
 #include <iostream>
 #include <sstream>
@@ -11,6 +12,7 @@ Vigenere::Vigenere(const std::string& text, Dictionary* dict, const std::string&
 
 // Encrypt text using Vigenère cipher with a key
 std::string Vigenere::encrypt() const {
+    FSCT_TRACE_SCOPE("Vigenere::encrypt");
     std::string result;
     int keyIndex = 0;
     for (char c : encryptedText) {
@@ -28,6 +30,7 @@ std::string Vigenere::encrypt() const {
 
 // Decrypt text using Vigenère cipher with a key
 std::string Vigenere::decrypt() const {
+    FSCT_TRACE_SCOPE("Vigenere::decrypt");
     std::string result;
     int keyIndex = 0;
     for (char c : encryptedText) {
@@ -47,6 +50,7 @@ std::string Vigenere::decrypt() const {
 
 // Suggest encryptions or decryptions based on dictionary matches
 void Vigenere::suggestDecryptions(int topN, const std::string& analysisMode, bool encryptMode) const {
+    FSCT_TRACE_SCOPE("Vigenere::suggestDecryptions");
     std::vector<DecryptionResult> results;
 
     for (int shift = 0; shift < 26; ++shift) {
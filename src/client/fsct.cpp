@@ -5,6 +5,7 @@
 #include <vector>
 #include <sstream>
 #include <fstream>
+#include <functional>
 #include <unordered_map>
 #include "../../include/ciphers/transposition.hpp"
 #include "../../include/ciphers/vigenere.hpp"
@@ -12,10 +13,32 @@
 #include "../../include/ciphers/caesar.hpp"
 #include "../../include/ciphers/playfair.hpp"
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/analysis/entropy_profiler.hpp"
+#include "../../include/analysis/crib_dragger.hpp"
+#include "../../include/concurrency/thread_pool.hpp"
+#include "../../include/engine/cipher_engine.hpp"
+#include "../../include/engine/batch_runner.hpp"
+#include "../../include/engine/cipher_server.hpp"
+#include "../../include/engine/cipher_client.hpp"
+#include "../../include/engine/jsonl.hpp"
+#include "../../include/engine/workload_generator.hpp"
+#include "../../include/telemetry/metrics.hpp"
+#include "../../include/telemetry/trace.hpp"
+#include <cctype>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
 
 // Function to display the help message
 void showHelp() {
-    std::cout << "Usage: fsct [ciphername] [options] [input]\n\n"
+    std::cout << "Usage: fsct [ciphername] [options] [input]\n"
+              << "       fsct entropy [--window=N] [--step=N] [--format=csv|binary] [--out=file] [file]\n"
+              << "       fsct crib vigenere|caesar --crib=[text] [--top=N] [--dictionary=file] [--dict-source=url] [ciphertext]\n"
+              << "       fsct batch --cipher=[name] [--mode=crack|encrypt|decrypt] [--key=K] [--in=file] [--out=file]\n"
+              << "       fsct serve --socket=[path] [--queue=N] [--dictionary=file] [--dict-source=url]\n"
+              << "       fsct client --socket=[path] --cipher=[name] [--mode=M] [--key=K] [text]\n"
+              << "       fsct gen --cipher=[name] [--keylen=N..M] [--size=1MB] [--count=N] [--seed=N] [--corpus=file] [--out=file]\n\n"
               << "Available ciphers:\n"
               << "  caesar    : Caesar cipher\n"
               << "  vigenere  : Vigenère cipher\n"
@@ -26,23 +49,83 @@ void showHelp() {
               << "  -e [key]  : Encrypt with the specified key (integer or string depending on cipher)\n"
               << "  -d [key]  : Decrypt with the specified key (integer or string depending on cipher)\n"
               << "  -h        : Show this help message\n"
+              << "  --threads=N : Worker threads shared by all analyses (default: all cores)\n"
+              << "  --metrics-out=[file] : Write Prometheus-format metrics to the file at exit\n"
+              << "  --trace=[file] : Record hot-path spans and write them as Chrome trace JSON at exit\n"
               << "  --dictionary=[filename] : Load a custom dictionary from the specified file\n"
               << "  --delim=[separator]    : Use the specified separator for dictionary\n"
+              << "  --dict-source=[url]    : Add a word list from file://path or http(s)://url, cached locally\n"
               << "  -s        : Suggest possible decryptions (basic mode)\n"
               << "  -sa       : Suggest possible decryptions (advanced mode)\n\n"
-              << "Input: Text to be encrypted or decrypted\n";
+              << "Input: Text to be encrypted or decrypted\n\n"
+              << "Entropy profile options:\n"
+              << "  --window=N     : Window size in bytes (default 4096)\n"
+              << "  --step=N       : Distance between window starts in bytes (default 512)\n"
+              << "  --format=F     : Output format, csv (default) or binary\n"
+              << "  --out=[file]   : Write the profile to a file instead of stdout\n"
+              << "  [file]         : File to profile; stdin is read when it is left out or is -\n\n"
+              << "Crib drag options:\n"
+              << "  --crib=[text]  : Known plaintext to slide over every offset of the ciphertext\n"
+              << "  --top=N        : Number of ranked placements to show (default 10)\n\n"
+              << "Batch options (one JSON object per line with \"text\" and optional \"id\", \"cipher\", \"mode\", \"key\"):\n"
+              << "  --cipher=[name] : Cipher for records that do not name one\n"
+              << "  --mode=M       : crack (default), encrypt or decrypt for records that do not name one\n"
+              << "  --key=K        : Key for records that do not carry one (affine keys are \"a,b\")\n"
+              << "  --in=[file]    : Input JSONL file (default stdin)\n"
+              << "  --out=[file]   : Output JSONL file, one result per record in input order (default stdout)\n\n"
+              << "Server options (requests run on --threads workers; SIGINT or SIGTERM stops the server):\n"
+              << "  --socket=[path] : Unix domain socket to listen on or connect to\n"
+              << "  --queue=N      : Requests queued before readers block (default 1024)\n"
+              << "Client mode sends [text], or each line of stdin when no text is given, and prints one JSON result per request;\n"
+              << "--mode=metrics prints the server's Prometheus metrics instead\n\n"
+              << "Generator options (writes batch-ready JSONL with \"expected_key\" and \"plaintext\" ground truth):\n"
+              << "  --cipher=[name] : Cipher to encrypt with (default vigenere)\n"
+              << "  --keylen=N..M  : Key length range for vigenere and playfair, columns for transposition (default 5..12)\n"
+              << "  --size=S       : Total plaintext size, split evenly across messages, e.g. 64KB or 1MB (default 1MB)\n"
+              << "  --count=N      : Number of messages (default 1000)\n"
+              << "  --seed=N       : Random seed; equal options and seeds give identical output (default 42)\n"
+              << "  --corpus=[file] : Learn word order from a text file instead of drawing dictionary words\n";
 }
 
 // Function to load dictionary
-std::shared_ptr<Dictionary> loadDictionary(const std::string& filename = "", const std::string& delimiter = " ") {
+std::shared_ptr<Dictionary> loadDictionary(const std::string& filename = "", const std::string& delimiter = " ",
+                                           const std::string& source = "") {
     auto dictionary = std::make_shared<Dictionary>();
     if (!filename.empty() && !dictionary->loadFromFile(filename, delimiter[0])) {
         std::cerr << "Failed to load dictionary from " << filename << "\n";
         exit(1);
     }
+    if (!source.empty() && !dictionary->loadFromSource(source)) {
+        exit(1);
+    }
     return dictionary;
 }
 
+// Parses the value of a numeric option such as --seed=N. Throws
+// std::invalid_argument naming the option unless text is a whole number of
+// at least minimum that fits in 64 bits.
+uint64_t parseNumber(const std::string& option, const std::string& text, uint64_t minimum) {
+    size_t used = 0;
+    unsigned long long value = 0;
+    try {
+        if (!text.empty() && std::isdigit(static_cast<unsigned char>(text[0]))) {
+            value = std::stoull(text, &used);
+        }
+    } catch (const std::out_of_range&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.length() || value < minimum) {
+        throw std::invalid_argument(option + (minimum > 0 ? " needs a positive integer, not \"" :
+                                              " needs a non-negative integer, not \"") + text + "\"");
+    }
+    return value;
+}
+
+// Parses the value of a count option such as --threads=N
+size_t parseCount(const std::string& option, const std::string& text) {
+    return parseNumber(option, text, 1);
+}
+
 enum CipherType {
     CAESAR,
     VIGENERE,
@@ -65,7 +148,539 @@ CipherType getCipherType(const std::string& cipherName) {
     return (it != cipherMap.end()) ? it->second : UNKNOWN;
 }
 
+// fsct entropy: stream a file through a sliding window and emit an entropy/IoC profile
+int runEntropyProfile(int argc, char* argv[]) {
+    size_t windowSize = 4096;
+    size_t stepSize = 512;
+    std::string format = "csv";
+    std::string outPath;
+    std::string inputPath = "-";
+
+    // The input file, when given, is the last argument; without it stdin is read
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option.rfind("--window=", 0) == 0) {
+                windowSize = parseCount("--window", option.substr(9));
+            } else if (option.rfind("--step=", 0) == 0) {
+                stepSize = parseCount("--step", option.substr(7));
+            } else if (option.rfind("--format=", 0) == 0) {
+                format = option.substr(9);
+            } else if (option.rfind("--out=", 0) == 0) {
+                outPath = option.substr(6);
+            } else if (i == argc - 1 && option.rfind("--", 0) != 0) {
+                inputPath = option;
+            } else {
+                std::cerr << "Invalid option: " << option << "\n";
+                showHelp();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid entropy option: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (format != "csv" && format != "binary") {
+        std::cerr << "Unknown output format: " << format << "\n";
+        return 1;
+    }
+
+    std::ofstream outFile;
+    if (!outPath.empty()) {
+        outFile.open(outPath, std::ios::binary);
+        if (!outFile.is_open()) {
+            std::cerr << "Failed to open output file: " << outPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = outPath.empty() ? std::cout : outFile;
+
+    try {
+        EntropyProfiler profiler(windowSize, stepSize);
+        std::function<void(const WindowProfile&)> emit;
+        if (format == "csv") {
+            EntropyProfiler::writeCsvHeader(out);
+            emit = [&out](const WindowProfile& profile) { EntropyProfiler::writeCsvRow(out, profile); };
+        } else {
+            EntropyProfiler::writeBinaryHeader(out, windowSize, stepSize);
+            emit = [&out](const WindowProfile& profile) { EntropyProfiler::writeBinaryRecord(out, profile); };
+        }
+        if (inputPath == "-") {
+            profiler.profileStream(std::cin, emit);
+        } else {
+            profiler.profileFile(inputPath, emit);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Entropy profile failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    out.flush();
+    return 0;
+}
+
+// fsct crib: known-plaintext attack, ranking every placement of the crib by its implied key
+int runCribDrag(int argc, char* argv[]) {
+    std::string cipherName = argv[2];
+    std::string ciphertext = argv[argc - 1];
+    std::string crib;
+    std::string dictionaryFilename;
+    std::string dictionarySource;
+    size_t topN = 10;
+
+    try {
+        for (int i = 3; i < argc - 1; ++i) {
+            std::string option = argv[i];
+            if (option.rfind("--crib=", 0) == 0) {
+                crib = option.substr(7);
+            } else if (option.rfind("--top=", 0) == 0) {
+                topN = parseCount("--top", option.substr(6));
+            } else if (option.rfind("--dictionary=", 0) == 0) {
+                dictionaryFilename = option.substr(13);
+            } else if (option.rfind("--dict-source=", 0) == 0) {
+                dictionarySource = option.substr(14);
+            } else {
+                std::cerr << "Invalid option: " << option << "\n";
+                showHelp();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid crib option: " << e.what() << "\n";
+        return 1;
+    }
+
+    CipherType cipherType = getCipherType(cipherName);
+    if (cipherType != VIGENERE && cipherType != CAESAR) {
+        std::cerr << "Crib dragging supports vigenere and caesar, not: " << cipherName << "\n";
+        return 1;
+    }
+    if (crib.empty()) {
+        std::cerr << "Crib dragging requires --crib=[text]\n";
+        return 1;
+    }
+
+    auto dictionary = loadDictionary(dictionaryFilename, " ", dictionarySource);
+    std::vector<CribHit> hits;
+    try {
+        CribDragger dragger(ciphertext, dictionary.get());
+        hits = cipherType == VIGENERE ? dragger.dragVigenere(crib, topN) : dragger.dragCaesar(crib, topN);
+    } catch (const std::exception& e) {
+        std::cerr << "Crib drag failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "\n=== Crib placements (" << cipherName << ") ===\n";
+    for (size_t rank = 0; rank < hits.size(); ++rank) {
+        const CribHit& hit = hits[rank];
+        std::cout << rank + 1 << ". offset " << hit.textOffset
+                  << "  fragment " << hit.keyFragment
+                  << "  key " << (hit.key.empty() ? "?" : hit.key)
+                  << "  score " << hit.score
+                  << " (periodic " << hit.periodicityScore << ", word " << hit.wordScore << ")\n";
+        if (!hit.key.empty()) {
+            std::string preview = cipherType == VIGENERE
+                ? Vigenere(ciphertext, dictionary.get(), hit.key).decrypt()
+                : Caesar(ciphertext, dictionary.get()).decrypt(hit.key[0] - 'a');
+            std::cout << "   " << preview.substr(0, 60) << "\n";
+        }
+    }
+    return 0;
+}
+
+// fsct batch: run a JSONL file of cipher jobs on the shared pool with one dictionary
+int runBatch(int argc, char* argv[]) {
+    BatchDefaults defaults;
+    std::string inPath = "-";
+    std::string outPath = "-";
+    std::string dictionaryFilename;
+    std::string dictionarySource;
+    std::string delimiter = " ";
+
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--cipher=", 0) == 0) {
+            defaults.cipher = option.substr(9);
+        } else if (option.rfind("--mode=", 0) == 0) {
+            defaults.mode = option.substr(7);
+        } else if (option.rfind("--key=", 0) == 0) {
+            defaults.key = option.substr(6);
+        } else if (option.rfind("--in=", 0) == 0) {
+            inPath = option.substr(5);
+        } else if (option.rfind("--out=", 0) == 0) {
+            outPath = option.substr(6);
+        } else if (option.rfind("--dictionary=", 0) == 0) {
+            dictionaryFilename = option.substr(13);
+        } else if (option.rfind("--dict-source=", 0) == 0) {
+            dictionarySource = option.substr(14);
+        } else if (option.rfind("--delim=", 0) == 0) {
+            delimiter = option.substr(8);
+        } else {
+            std::cerr << "Invalid option: " << option << "\n";
+            showHelp();
+            return 1;
+        }
+    }
+
+    if (defaults.mode != "crack" && defaults.mode != "encrypt" && defaults.mode != "decrypt") {
+        std::cerr << "Unknown batch mode: " << defaults.mode << "\n";
+        return 1;
+    }
+
+    std::ifstream inFile;
+    if (inPath != "-") {
+        inFile.open(inPath);
+        if (!inFile.is_open()) {
+            std::cerr << "Failed to open input file: " << inPath << "\n";
+            return 1;
+        }
+    }
+    std::ofstream outFile;
+    if (outPath != "-") {
+        outFile.open(outPath, std::ios::binary);
+        if (!outFile.is_open()) {
+            std::cerr << "Failed to open output file: " << outPath << "\n";
+            return 1;
+        }
+    }
+
+    auto dictionary = loadDictionary(dictionaryFilename, delimiter, dictionarySource);
+    CipherEngine engine(dictionary);
+    BatchRunner runner(engine);
+    BatchSummary summary = runner.run(inPath == "-" ? std::cin : inFile,
+                                      outPath == "-" ? std::cout : outFile, defaults);
+
+    std::cerr << "Processed " << summary.records << " records, " << summary.failed << " failed\n";
+    return 0;
+}
+
+CipherServer* activeServer = nullptr;
+
+void stopActiveServer(int) {
+    if (activeServer) activeServer->stop();
+}
+
+// fsct serve: keep the dictionary and scoring model resident and answer socket requests
+int runServer(int argc, char* argv[]) {
+    std::string socketPath;
+    size_t queueCapacity = 1024;
+    std::string dictionaryFilename;
+    std::string dictionarySource;
+    std::string delimiter = " ";
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option.rfind("--socket=", 0) == 0) {
+                socketPath = option.substr(9);
+            } else if (option.rfind("--queue=", 0) == 0) {
+                queueCapacity = parseCount("--queue", option.substr(8));
+            } else if (option.rfind("--dictionary=", 0) == 0) {
+                dictionaryFilename = option.substr(13);
+            } else if (option.rfind("--dict-source=", 0) == 0) {
+                dictionarySource = option.substr(14);
+            } else if (option.rfind("--delim=", 0) == 0) {
+                delimiter = option.substr(8);
+            } else {
+                std::cerr << "Invalid option: " << option << "\n";
+                showHelp();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid server option: " << e.what() << "\n";
+        return 1;
+    }
+    if (socketPath.empty()) {
+        std::cerr << "fsct serve requires --socket=[path]\n";
+        return 1;
+    }
+
+    // A server always collects metrics so fsct client --mode=metrics has
+    // something to return, with or without --metrics-out
+    MetricsRegistry::global();
+    MetricsRegistry::setEnabled(true);
+
+    auto dictionary = loadDictionary(dictionaryFilename, delimiter, dictionarySource);
+    CipherEngine engine(dictionary);
+    try {
+        CipherServer server(engine, socketPath, ThreadPool::global().size(), queueCapacity);
+        activeServer = &server;
+        std::signal(SIGINT, stopActiveServer);
+        std::signal(SIGTERM, stopActiveServer);
+        std::cerr << "Serving on " << socketPath << "\n";
+        server.run();
+        activeServer = nullptr;
+    } catch (const std::exception& e) {
+        activeServer = nullptr;
+        std::cerr << "Server failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// fsct client: send jobs to a running fsct serve
+int runClient(int argc, char* argv[]) {
+    std::string socketPath;
+    CipherJob job;
+    job.mode = "crack";
+    std::string text;
+    bool haveText = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--socket=", 0) == 0) {
+            socketPath = option.substr(9);
+        } else if (option.rfind("--cipher=", 0) == 0) {
+            job.cipher = option.substr(9);
+        } else if (option.rfind("--mode=", 0) == 0) {
+            job.mode = option.substr(7);
+        } else if (option.rfind("--key=", 0) == 0) {
+            job.key = option.substr(6);
+        } else if (i == argc - 1 && option.rfind("--", 0) != 0) {
+            text = option;
+            haveText = true;
+        } else {
+            std::cerr << "Invalid option: " << option << "\n";
+            showHelp();
+            return 1;
+        }
+    }
+    if (socketPath.empty()) {
+        std::cerr << "fsct client requires --socket=[path]\n";
+        return 1;
+    }
+
+    try {
+        CipherClient client(socketPath);
+        if (job.mode == "metrics") {
+            CipherJobResult result = client.call(job);
+            std::cout << (result.ok ? result.output : result.error);
+            return result.ok ? 0 : 1;
+        }
+        auto send = [&](const std::string& payload) {
+            job.text = payload;
+            CipherJobResult result = client.call(job);
+            JsonRecordBuilder output;
+            if (result.ok) {
+                output.add("ok", true).add("key", result.key);
+                if (job.mode == "crack") output.add("score", result.score);
+                output.add("text", result.output);
+            } else {
+                output.add("ok", false).add("error", result.error);
+            }
+            std::cout << output.str() << "\n";
+            return result.ok;
+        };
+
+        if (haveText) {
+            return send(text) ? 0 : 1;
+        }
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            send(line);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Client failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Parses a byte count such as 4096, 64KB or 1MB (binary multiples). Throws
+// std::invalid_argument for anything else, including sizes past 64 bits.
+size_t parseByteSize(const std::string& text) {
+    size_t digits = 0;
+    while (digits < text.length() && std::isdigit(static_cast<unsigned char>(text[digits]))) ++digits;
+    std::string unit = text.substr(digits);
+    for (auto& c : unit) c = std::toupper(static_cast<unsigned char>(c));
+    int shift = 0;
+    if (unit == "K" || unit == "KB") {
+        shift = 10;
+    } else if (unit == "M" || unit == "MB") {
+        shift = 20;
+    } else if (unit == "G" || unit == "GB") {
+        shift = 30;
+    } else if (!unit.empty() && unit != "B") {
+        shift = -1;
+    }
+    if (digits == 0 || shift < 0) {
+        throw std::invalid_argument("--size needs a size such as 4096, 64KB or 1MB, not \"" + text + "\"");
+    }
+    uint64_t value = parseNumber("--size", text.substr(0, digits), 1);
+    if (value > (std::numeric_limits<uint64_t>::max() >> shift)) {
+        throw std::invalid_argument("--size is too large: " + text);
+    }
+    return value << shift;
+}
+
+// fsct gen: write a reproducible JSONL workload of encrypted messages with their keys
+int runGenerator(int argc, char* argv[]) {
+    WorkloadOptions options;
+    std::string corpusPath;
+    std::string outPath = "-";
+    std::string dictionaryFilename;
+    std::string dictionarySource;
+    std::string delimiter = " ";
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option.rfind("--cipher=", 0) == 0) {
+                options.cipher = option.substr(9);
+            } else if (option.rfind("--keylen=", 0) == 0) {
+                std::string range = option.substr(9);
+                size_t dots = range.find("..");
+                options.minKeyLength = parseCount("--keylen", range.substr(0, dots));
+                options.maxKeyLength = dots == std::string::npos ? options.minKeyLength
+                                                                 : parseCount("--keylen", range.substr(dots + 2));
+            } else if (option.rfind("--size=", 0) == 0) {
+                options.totalBytes = parseByteSize(option.substr(7));
+            } else if (option.rfind("--count=", 0) == 0) {
+                options.count = parseCount("--count", option.substr(8));
+            } else if (option.rfind("--seed=", 0) == 0) {
+                options.seed = parseNumber("--seed", option.substr(7), 0);
+            } else if (option.rfind("--corpus=", 0) == 0) {
+                corpusPath = option.substr(9);
+            } else if (option.rfind("--out=", 0) == 0) {
+                outPath = option.substr(6);
+            } else if (option.rfind("--dictionary=", 0) == 0) {
+                dictionaryFilename = option.substr(13);
+            } else if (option.rfind("--dict-source=", 0) == 0) {
+                dictionarySource = option.substr(14);
+            } else if (option.rfind("--delim=", 0) == 0) {
+                delimiter = option.substr(8);
+            } else {
+                std::cerr << "Invalid option: " << option << "\n";
+                showHelp();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid generator option: " << e.what() << "\n";
+        return 1;
+    }
+
+    auto dictionary = loadDictionary(dictionaryFilename, delimiter, dictionarySource);
+    std::ofstream outFile;
+    if (outPath != "-") {
+        outFile.open(outPath, std::ios::binary);
+        if (!outFile.is_open()) {
+            std::cerr << "Failed to open output file: " << outPath << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        MarkovTextModel model = MarkovTextModel::fromWords(dictionary->getWords());
+        if (!corpusPath.empty()) {
+            std::ifstream corpus(corpusPath);
+            if (!corpus.is_open()) {
+                std::cerr << "Failed to open corpus: " << corpusPath << "\n";
+                return 1;
+            }
+            model = MarkovTextModel::fromCorpus(corpus);
+        }
+
+        CipherEngine engine(dictionary);
+        WorkloadGenerator generator(engine, model, options);
+        size_t written = generator.run(outPath == "-" ? std::cout : outFile);
+        std::cerr << "Generated " << written << " " << options.cipher << " messages from "
+                  << model.vocabularySize() << " distinct words\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Generation failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+std::string metricsOutPath;
+std::string traceOutPath;
+
+// Runs at exit so every mode, including early exits, leaves a metrics dump.
+// It must not touch the thread pool, which may already be destroyed.
+void writeMetricsAtExit() {
+    std::ofstream out(metricsOutPath);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write metrics to " << metricsOutPath << "\n";
+        return;
+    }
+    MetricsRegistry::global().writePrometheus(out);
+}
+
+void writeTraceAtExit() {
+    Tracer::stop();
+    std::ofstream out(traceOutPath);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write trace to " << traceOutPath << "\n";
+        return;
+    }
+    Tracer::writeChromeTrace(out);
+}
+
+// Strip the options that apply to every mode: --threads=N sizes the shared
+// pool, --metrics-out=file enables metrics and --trace=file enables tracing;
+// both files are written at exit
+bool applyGlobalOptions(int& argc, char* argv[]) {
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--threads=", 0) == 0) {
+            try {
+                ThreadPool::setGlobalThreadCount(parseCount("--threads", option.substr(10)));
+            } catch (const std::invalid_argument& e) {
+                std::cerr << e.what() << "\n";
+                return false;
+            }
+        } else if (option.rfind("--metrics-out=", 0) == 0) {
+            metricsOutPath = option.substr(14);
+        } else if (option.rfind("--trace=", 0) == 0) {
+            traceOutPath = option.substr(8);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    if (!metricsOutPath.empty()) {
+        // Create the registry first so it outlives the exit handler
+        MetricsRegistry::global();
+        MetricsRegistry::setEnabled(true);
+        std::atexit(writeMetricsAtExit);
+    }
+    if (!traceOutPath.empty()) {
+        // Starting the tracer creates its state before the exit handler is registered
+        Tracer::start();
+        std::atexit(writeTraceAtExit);
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    if (!applyGlobalOptions(argc, argv)) {
+        return 1;
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "entropy") {
+        return runEntropyProfile(argc, argv);
+    }
+    if (argc >= 4 && std::string(argv[1]) == "crib") {
+        return runCribDrag(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "batch") {
+        return runBatch(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "serve") {
+        return runServer(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "client") {
+        return runClient(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "gen") {
+        return runGenerator(argc, argv);
+    }
+
     if (argc < 3) {
         showHelp();
         return 1;
@@ -74,6 +689,7 @@ int main(int argc, char* argv[]) {
     std::string cipherName = argv[1];
     std::string input = argv[argc - 1];
     std::string dictionaryFilename = "";
+    std::string dictionarySource = "";
     std::string delimiter = " ";
 
     int key = 0;
@@ -81,9 +697,6 @@ int main(int argc, char* argv[]) {
     bool encrypt = false, decrypt = false;
     bool suggest = false, advancedSuggest = false;
 
-    // Load dictionary
-    auto dictionary = loadDictionary(dictionaryFilename, delimiter);
-
     // Parse options
     for (int i = 2; i < argc - 1; ++i) {
         std::string option = argv[i];
@@ -125,10 +738,12 @@ int main(int argc, char* argv[]) {
         } else if (option == "-sa") {
             suggest = true;
             advancedSuggest = true;
-        } else if (option.substr(0, 12) == "--dictionary=") {
-            dictionaryFilename = option.substr(12);
-        } else if (option.substr(0, 9) == "--delim=") {
-            delimiter = option.substr(9);
+        } else if (option.substr(0, 13) == "--dictionary=") {
+            dictionaryFilename = option.substr(13);
+        } else if (option.substr(0, 14) == "--dict-source=") {
+            dictionarySource = option.substr(14);
+        } else if (option.substr(0, 8) == "--delim=") {
+            delimiter = option.substr(8);
         } else {
             std::cerr << "Invalid option: " << option << "\n";
             showHelp();
@@ -141,6 +756,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Load dictionary once the options naming it have been parsed
+    auto dictionary = loadDictionary(dictionaryFilename, delimiter, dictionarySource);
+
     // Create cipher objects
     CipherType cipherType = getCipherType(cipherName);
     switch (cipherType) {
@@ -0,0 +1,231 @@
+#include "../../include/concurrency/thread_pool.hpp"
+#include "../../include/telemetry/metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+// Identifies the pool worker running on this thread, if any
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+std::mutex globalMutex;
+size_t globalThreadCount = 0;
+bool globalCreated = false;
+
+// How long a waiting thread sleeps between looks for work to help with
+constexpr auto HELP_INTERVAL = std::chrono::microseconds(200);
+}
+
+CancellationToken::CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {
+}
+
+void CancellationToken::cancel() {
+    flag->store(true, std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const {
+    return flag->load(std::memory_order_relaxed);
+}
+
+ThreadPool::ThreadPool(size_t threads) : pending(0), nextQueue(0), stopping(false) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+// Workers push onto their own deque so nested work stays cache-local; other
+// threads spread submissions round-robin. pending is raised before the task
+// is visible, so a worker that pops it at once can never take it below zero.
+void ThreadPool::submit(std::function<void()> task) {
+    size_t target = (currentPool == this) ? currentWorker
+                                          : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        depth = ++pending;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+
+    if (MetricsRegistry::enabled()) {
+        static Gauge& maxDepth = MetricsRegistry::global().gauge(
+            "fsct_thread_pool_queue_depth_max", "Most tasks ever queued in a thread pool at once");
+        static Counter& submitted = MetricsRegistry::global().counter(
+            "fsct_thread_pool_tasks_total", "Tasks submitted to thread pools");
+        maxDepth.observeMax(static_cast<int64_t>(depth));
+        submitted.add();
+    }
+}
+
+bool ThreadPool::popTask(size_t home, std::function<void()>& task) {
+    {
+        WorkQueue& own = *queues[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending--;
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(home + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    if (pending.load() == 0) return false;
+    size_t home = (currentPool == this) ? currentWorker : 0;
+    std::function<void()> task;
+    if (!popTask(home, task)) return false;
+    try {
+        task();
+    } catch (...) {
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (popTask(index, task)) {
+            try {
+                task();
+            } catch (...) {
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || pending > 0; });
+        if (stopping && pending == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body,
+                             const CancellationToken& token) {
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+
+    if (count <= grain) {
+        if (!token.isCancelled()) body(0, count);
+        return;
+    }
+
+    TaskGroup group(*this, token);
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(count, begin + grain);
+        group.run([&body, begin, end]() { body(begin, end); });
+    }
+    group.wait();
+}
+
+ThreadPool& ThreadPool::global() {
+    size_t threads;
+    {
+        std::lock_guard<std::mutex> lock(globalMutex);
+        globalCreated = true;
+        threads = globalThreadCount;
+    }
+    static ThreadPool pool(threads);
+    return pool;
+}
+
+void ThreadPool::setGlobalThreadCount(size_t threads) {
+    std::lock_guard<std::mutex> lock(globalMutex);
+    if (globalCreated) {
+        throw std::logic_error("Global thread pool is already running");
+    }
+    globalThreadCount = threads;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool, const CancellationToken& token)
+    : pool(pool), cancellation(token), outstanding(0) {
+}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    if (cancellation.isCancelled()) return;
+    outstanding++;
+    pool.submit([this, task = std::move(task)]() {
+        if (!cancellation.isCancelled()) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!error) error = std::current_exception();
+            }
+        }
+        // Decrement under the lock so wait() cannot return and destroy the
+        // group between the decrement and the notification.
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (--outstanding == 0) finished.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    while (outstanding.load() > 0) {
+        if (!pool.runPendingTask()) {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            finished.wait_for(lock, HELP_INTERVAL, [this]() { return outstanding.load() == 0; });
+        }
+    }
+
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        std::swap(failure, error);
+    }
+    if (failure) std::rethrow_exception(failure);
+}
+
+void TaskGroup::cancel() {
+    cancellation.cancel();
+}
+
+const CancellationToken& TaskGroup::token() const {
+    return cancellation;
+}
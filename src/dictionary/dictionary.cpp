@@ -1,8 +1,13 @@
 #include "../../include/dictionary/dictionary.hpp"
+#include "../../include/analysis/histogram.hpp"
+#include "../../include/dictionary/dictionary_cache.hpp"
+#include "../../include/telemetry/metrics.hpp"
+#include "../../include/telemetry/trace.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cmath>
 #include <map>
@@ -44,6 +49,22 @@ bool Dictionary::loadFromFile(const std::string& filename, char delimiter) {
     return true;
 }
 
+bool Dictionary::loadFromSource(const std::string& source) {
+    std::vector<std::string> words;
+    try {
+        words = DictionaryCache().load(source);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load dictionary from " << source << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    dictionary.reserve(dictionary.size() + words.size());
+    for (auto& word : words) {
+        dictionary.insert(std::move(word));
+    }
+    return true;
+}
+
 
 void Dictionary::addWord(const std::string& word) {
     dictionary.insert(cleanWord(word));
@@ -148,14 +169,25 @@ std::vector<std::string> Dictionary::getTopNFrequentWords(const std::string& tex
     return result;
 }
 int Dictionary::countMatches(const std::string& text) const {
+    FSCT_TRACE_SCOPE("Dictionary::countMatches");
     std::istringstream iss(text);
     std::string word;
     int matchCount = 0;
+    int lookupCount = 0;
     while (iss >> word) {
+        lookupCount++;
         if (isInDictionary(cleanWord(word))) {
             matchCount++;
         }
     }
+    if (MetricsRegistry::enabled()) {
+        static Counter& lookups = MetricsRegistry::global().counter(
+            "fsct_dictionary_lookups_total", "Words looked up by Dictionary::countMatches");
+        static Counter& hits = MetricsRegistry::global().counter(
+            "fsct_dictionary_hits_total", "Looked-up words found in the dictionary");
+        lookups.add(lookupCount);
+        hits.add(matchCount);
+    }
     return matchCount;
 }
 // Returns the number of words in the dictionary
@@ -163,6 +195,13 @@ int Dictionary::size() const {
     return dictionary.size();
 }
 
+// Sorted, so callers see the same order on every platform
+std::vector<std::string> Dictionary::getWords() const {
+    std::vector<std::string> words(dictionary.begin(), dictionary.end());
+    std::sort(words.begin(), words.end());
+    return words;
+}
+
 // Returns the longest word in the dictionary
 std::string Dictionary::getLongestWord() const {
     std::string longest;
@@ -306,19 +345,13 @@ double Dictionary::indexOfCoincidenceOverSubstrings(const std::string& text, int
     int substringCount = 0;
 
     for (size_t i = 0; i + substringLength <= text.size(); i += substringLength) {
-        std::string substring = text.substr(i, substringLength);
-
-        std::unordered_map<char, int> freq;
-        for (char c : substring) {
-            if (std::isalpha(c)) {
-                freq[std::tolower(c)]++;
-            }
-        }
+        std::array<uint64_t, 26> freq{};
+        HistogramKernel::countLetters(text.data() + i, substringLength, freq);
 
-        int n = substring.size();
+        int n = substringLength;
         double ic = 0;
-        for (const auto& [ch, count] : freq) {
-            ic += count * (count - 1);
+        for (uint64_t count : freq) {
+            ic += count * (count > 0 ? count - 1 : 0);
         }
 
         if (n > 1) {
@@ -0,0 +1,274 @@
+#include "../../include/dictionary/dictionary_cache.hpp"
+#include "../../include/telemetry/metrics.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <curl/curl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const char MAGIC[8] = {'F', 'S', 'C', 'T', 'D', 'I', 'C', '1'};
+const std::string FILE_SCHEME = "file://";
+
+size_t appendToString(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+void countCacheResult(bool hit) {
+    if (!MetricsRegistry::enabled()) return;
+    MetricsRegistry::global().counter("fsct_dictionary_cache_requests_total",
+                                      "Dictionary source loads by whether the compiled cache served them",
+                                      {{"result", hit ? "hit" : "miss"}}).add();
+}
+
+std::string toHex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        hex[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+    return hex;
+}
+
+void putLE(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t getLE(const char* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+bool readFile(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// Write to a uniquely named temporary file and rename it into place, so
+// readers never see a partial file and concurrent writers never share one
+void writeFileAtomically(const std::string& path, const std::string& content) {
+    std::string temporary = path + ".XXXXXX";
+    int fd = ::mkstemp(&temporary[0]);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create dictionary cache file: " + temporary);
+    }
+    ::fchmod(fd, 0644);  // mkstemp creates 0600; cache files are not secret
+
+    size_t done = 0;
+    while (done < content.size()) {
+        ssize_t wrote = ::write(fd, content.data() + done, content.size() - done);
+        if (wrote < 0 && errno == EINTR) continue;
+        if (wrote <= 0) break;
+        done += static_cast<size_t>(wrote);
+    }
+    bool written = ::close(fd) == 0 && done == content.size();
+
+    std::error_code error;
+    if (written) std::filesystem::rename(temporary, path, error);
+    if (!written || error) {
+        ::unlink(temporary.c_str());
+        throw std::runtime_error("Failed to write dictionary cache file: " + path);
+    }
+}
+}
+
+DictionaryCache::DictionaryCache(const std::string& cacheDirectory) : directory(cacheDirectory) {
+}
+
+std::string DictionaryCache::defaultDirectory() {
+    if (const char* explicitDir = std::getenv("FSCT_CACHE_DIR")) {
+        return explicitDir;
+    }
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        return std::string(xdg) + "/fsct";
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return std::string(home) + "/.cache/fsct";
+    }
+    return ".fsct-cache";
+}
+
+uint64_t DictionaryCache::fnv1a(const char* data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string DictionaryCache::objectPath(uint64_t contentHash) const {
+    return directory + "/objects/" + toHex(contentHash) + ".dict";
+}
+
+std::string DictionaryCache::refPath(const std::string& source) const {
+    return directory + "/refs/" + toHex(fnv1a(source.data(), source.length())) + ".ref";
+}
+
+// A ref file holds the source URL and the hash of the content it resolved to;
+// the URL is checked so a hash collision between URLs cannot mix them up.
+// A missing or corrupt ref is a cache miss.
+bool DictionaryCache::readRef(const std::string& source, uint64_t& contentHash) const {
+    std::ifstream file(refPath(source));
+    std::string storedSource, hex;
+    if (!std::getline(file, storedSource) || !std::getline(file, hex)) return false;
+    if (storedSource != source || hex.length() != 16) return false;
+    if (!std::all_of(hex.begin(), hex.end(), [](unsigned char c) { return std::isxdigit(c); })) return false;
+    contentHash = std::stoull(hex, nullptr, 16);
+    return true;
+}
+
+void DictionaryCache::writeRef(const std::string& source, uint64_t contentHash) const {
+    writeFileAtomically(refPath(source), source + "\n" + toHex(contentHash) + "\n");
+}
+
+std::vector<std::string> DictionaryCache::load(const std::string& source) {
+    bool local = source.rfind(FILE_SCHEME, 0) == 0;
+    std::vector<std::string> words;
+
+    uint64_t contentHash = 0;
+    if (!local && readRef(source, contentHash) && readCompiled(objectPath(contentHash), words)) {
+        countCacheResult(true);
+        return words;
+    }
+
+    std::string content;
+    if (local) {
+        std::string path = source.substr(FILE_SCHEME.length());
+        if (!readFile(path, content)) {
+            throw std::runtime_error("Failed to read dictionary source: " + path);
+        }
+    } else {
+        content = fetch(source);
+    }
+
+    contentHash = fnv1a(content.data(), content.length());
+    std::string object = objectPath(contentHash);
+    bool cached = readCompiled(object, words);
+    countCacheResult(cached);
+    if (!cached) {
+        words = compileWords(content);
+    }
+
+    // The cache is an optimisation; an unwritable cache directory must not
+    // stop the dictionary from loading.
+    try {
+        if (!cached) {
+            std::filesystem::create_directories(directory + "/objects");
+            writeCompiled(object, words);
+        }
+        if (!local) {
+            std::filesystem::create_directories(directory + "/refs");
+            writeRef(source, contentHash);
+        }
+    } catch (const std::exception&) {
+    }
+    return words;
+}
+
+std::string DictionaryCache::fetch(const std::string& source) {
+    if (source.rfind("http://", 0) != 0 && source.rfind("https://", 0) != 0) {
+        throw std::invalid_argument("Unsupported dictionary source: " + source);
+    }
+
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        throw std::runtime_error("Failed to initialise libcurl");
+    }
+
+    std::string buffer;
+    curl_easy_setopt(curl, CURLOPT_URL, source.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendToString);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        throw std::runtime_error("Dictionary " + source + " is not cached and could not be downloaded: " +
+                                 curl_easy_strerror(res));
+    }
+    return buffer;
+}
+
+// One word per line, reduced to lowercase letters like the dictionaries do
+std::vector<std::string> DictionaryCache::compileWords(const std::string& content) {
+    std::vector<std::string> words;
+    std::string word;
+    for (size_t i = 0; i <= content.length(); ++i) {
+        char c = i < content.length() ? content[i] : '\n';
+        if (c == '\n') {
+            if (!word.empty()) words.push_back(word);
+            word.clear();
+        } else if (std::isalpha(static_cast<unsigned char>(c))) {
+            word += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+bool DictionaryCache::readCompiled(const std::string& path, std::vector<std::string>& words) {
+    std::string data;
+    if (!readFile(path, data)) return false;
+
+    const size_t headerSize = sizeof(MAGIC) + 16;
+    if (data.length() < headerSize || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+    uint64_t count = getLE(data.data() + 8, 8);
+    uint64_t blobSize = getLE(data.data() + 16, 8);
+    if (count > data.length() || headerSize + (count + 1) * 4 + blobSize != data.length()) return false;
+
+    const char* offsets = data.data() + headerSize;
+    const char* blob = offsets + (count + 1) * 4;
+    words.clear();
+    words.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t begin = getLE(offsets + i * 4, 4);
+        uint64_t end = getLE(offsets + (i + 1) * 4, 4);
+        if (begin > end || end > blobSize) return false;
+        words.emplace_back(blob + begin, end - begin);
+    }
+    return true;
+}
+
+void DictionaryCache::writeCompiled(const std::string& path, const std::vector<std::string>& words) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    size_t blobSize = 0;
+    for (const auto& word : words) blobSize += word.length();
+    if (blobSize > UINT32_MAX) {
+        throw std::length_error("Dictionary too large for the compiled format");
+    }
+
+    putLE(out, words.size(), 8);
+    putLE(out, blobSize, 8);
+    uint64_t offset = 0;
+    putLE(out, offset, 4);
+    for (const auto& word : words) {
+        offset += word.length();
+        putLE(out, offset, 4);
+    }
+    for (const auto& word : words) {
+        out += word;
+    }
+    writeFileAtomically(path, out);
+}
@@ -0,0 +1,105 @@
+#include "../../include/engine/batch_runner.hpp"
+#include "../../include/engine/jsonl.hpp"
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// Records read per window for each pool thread, and records per task
+constexpr size_t WINDOW_PER_THREAD = 256;
+constexpr size_t RECORDS_PER_TASK = 8;
+
+std::string fieldOr(const JsonRecord& record, const std::string& name, const std::string& fallback) {
+    auto it = record.find(name);
+    return it != record.end() ? it->second.text : fallback;
+}
+
+bool isBlank(const std::string& line) {
+    return line.find_first_not_of(" \t\r") == std::string::npos;
+}
+}
+
+BatchRunner::BatchRunner(const CipherEngine& engine, ThreadPool& pool) : engine(engine), pool(pool) {
+}
+
+BatchSummary BatchRunner::run(std::istream& in, std::ostream& out, const BatchDefaults& defaults) const {
+    BatchSummary summary;
+    JsonlWriter writer(out);
+    const size_t window = pool.size() * WINDOW_PER_THREAD;
+
+    std::vector<std::string> lines;
+    std::vector<size_t> lineNumbers;
+    std::vector<std::string> results;
+    std::vector<char> succeeded;
+    size_t lineNumber = 0;
+    std::string line;
+    bool more = true;
+
+    while (more) {
+        lines.clear();
+        lineNumbers.clear();
+        while (lines.size() < window && (more = static_cast<bool>(std::getline(in, line)))) {
+            ++lineNumber;
+            if (isBlank(line)) continue;
+            lines.push_back(std::move(line));
+            lineNumbers.push_back(lineNumber);
+        }
+
+        results.assign(lines.size(), std::string());
+        succeeded.assign(lines.size(), 0);
+        pool.parallelFor(lines.size(), RECORDS_PER_TASK, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                bool ok = false;
+                results[i] = processLine(lines[i], lineNumbers[i], defaults, ok);
+                succeeded[i] = ok;
+            }
+        });
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            writer.write(results[i]);
+            summary.records++;
+            summary.failed += !succeeded[i];
+        }
+    }
+
+    writer.flush();
+    return summary;
+}
+
+std::string BatchRunner::processLine(const std::string& line, size_t lineNumber, const BatchDefaults& defaults,
+                                     bool& ok) const {
+    JsonRecordBuilder output;
+    output.add("line", lineNumber);
+
+    JsonRecord record;
+    try {
+        record = parseJsonRecord(line);
+    } catch (const std::invalid_argument& e) {
+        ok = false;
+        return output.add("ok", false).add("error", e.what()).str();
+    }
+
+    auto id = record.find("id");
+    if (id != record.end()) output.add("id", id->second);
+
+    auto text = record.find("text");
+    if (text == record.end()) {
+        ok = false;
+        return output.add("ok", false).add("error", "record has no \"text\" field").str();
+    }
+
+    CipherJob job;
+    job.cipher = fieldOr(record, "cipher", defaults.cipher);
+    job.mode = fieldOr(record, "mode", defaults.mode);
+    job.key = fieldOr(record, "key", defaults.key);
+    job.text = text->second.text;
+
+    CipherJobResult result = engine.run(job);
+    ok = result.ok;
+    if (!result.ok) {
+        return output.add("ok", false).add("error", result.error).str();
+    }
+
+    output.add("ok", true).add("cipher", job.cipher).add("mode", job.mode).add("key", result.key);
+    if (job.mode == "crack") output.add("score", result.score);
+    return output.add("text", result.output).str();
+}
@@ -0,0 +1,43 @@
+#include "../../include/engine/cipher_client.hpp"
+#include "../../include/engine/frame_protocol.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+CipherClient::CipherClient(const std::string& socketPath) : fd(-1), nextId(1) {
+    sockaddr_un address{};
+    if (socketPath.length() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + socketPath);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::string reason = std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        throw std::runtime_error("Failed to connect to " + socketPath + ": " + reason);
+    }
+}
+
+CipherClient::~CipherClient() {
+    ::close(fd);
+}
+
+CipherJobResult CipherClient::call(const CipherJob& job) {
+    FrameRequest request;
+    request.id = nextId++;
+    request.job = job;
+    writeFrame(fd, encodeRequest(request));
+
+    std::string body;
+    while (readFrame(fd, body)) {
+        FrameResponse response = decodeResponse(body);
+        // id 0 answers a request the server could not decode
+        if (response.id == request.id || response.id == 0) return response.result;
+    }
+    throw std::runtime_error("Server closed the connection");
+}
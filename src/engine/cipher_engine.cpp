@@ -0,0 +1,348 @@
+#include "../../include/engine/cipher_engine.hpp"
+#include "../../include/ciphers/affine.hpp"
+#include "../../include/ciphers/caesar.hpp"
+#include "../../include/ciphers/playfair.hpp"
+#include "../../include/ciphers/transposition.hpp"
+#include "../../include/ciphers/vigenere.hpp"
+#include "../../include/analysis/pattern_finder.hpp"
+#include "../../include/telemetry/metrics.hpp"
+#include "../../include/telemetry/trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr double ENGLISH_FREQUENCIES[26] = {
+    0.08167, 0.01492, 0.02782, 0.04253, 0.12702, 0.02228, 0.02015, 0.06094, 0.06966,
+    0.00153, 0.00772, 0.04025, 0.02406, 0.06749, 0.07507, 0.01929, 0.00095, 0.05987,
+    0.06327, 0.09056, 0.02758, 0.00978, 0.02360, 0.00150, 0.01974, 0.00074
+};
+
+constexpr int AFFINE_MULTIPLIERS[12] = {1, 3, 5, 7, 9, 11, 15, 17, 19, 21, 23, 25};
+
+// Candidates that get the dictionary pass after cheap likelihood ranking
+constexpr size_t REFINE_COUNT = 4;
+constexpr size_t MAX_VIGENERE_KEY = 20;
+constexpr size_t VIGENERE_PERIODS = 5;
+// Periods ranked below this share of the best period's confidence are skipped
+constexpr double PERIOD_CONFIDENCE_RATIO = 0.5;
+
+using LetterCounts = std::array<uint64_t, 26>;
+
+int parseInteger(const std::string& key) {
+    size_t used = 0;
+    int value = 0;
+    try {
+        value = std::stoi(key, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (key.empty() || used != key.length()) {
+        throw std::invalid_argument("key must be an integer, got \"" + key + "\"");
+    }
+    return value;
+}
+
+int modInverse26(int a) {
+    for (int x = 1; x < 26; ++x) {
+        if ((a * x) % 26 == 1) return x;
+    }
+    return -1;
+}
+
+// "a,b" with a coprime to 26
+void parseAffineKey(const std::string& key, int& a, int& b) {
+    size_t comma = key.find(',');
+    if (comma == std::string::npos) {
+        throw std::invalid_argument("affine key must be \"a,b\", got \"" + key + "\"");
+    }
+    a = ((parseInteger(key.substr(0, comma)) % 26) + 26) % 26;
+    b = ((parseInteger(key.substr(comma + 1)) % 26) + 26) % 26;
+    if (modInverse26(a) < 0) {
+        throw std::invalid_argument("affine multiplier must be coprime to 26");
+    }
+}
+
+std::string letterKey(const std::string& key) {
+    if (key.empty()) {
+        throw std::invalid_argument("key must not be empty");
+    }
+    std::string lower;
+    for (char c : key) {
+        if (!std::isalpha(static_cast<unsigned char>(c))) {
+            throw std::invalid_argument("key must contain only letters, got \"" + key + "\"");
+        }
+        lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+}
+
+std::vector<uint8_t> lettersOf(const std::string& text) {
+    std::vector<uint8_t> letters;
+    letters.reserve(text.length());
+    for (char c : text) {
+        if (std::isalpha(static_cast<unsigned char>(c))) {
+            letters.push_back(static_cast<uint8_t>(std::tolower(static_cast<unsigned char>(c)) - 'a'));
+        }
+    }
+    return letters;
+}
+
+// Shortest prefix the key is a repetition of, so "lemonlemon" reports "lemon"
+std::string primitiveKey(const std::string& key) {
+    for (size_t period = 1; period < key.length(); ++period) {
+        if (key.length() % period != 0) continue;
+        bool repeats = true;
+        for (size_t i = period; i < key.length() && repeats; ++i) {
+            repeats = key[i] == key[i - period];
+        }
+        if (repeats) return key.substr(0, period);
+    }
+    return key;
+}
+}
+
+CipherEngine::CipherEngine(std::shared_ptr<Dictionary> dictionary)
+    : dictionary(std::move(dictionary)), randomMean(0.0), englishMean(0.0) {
+    if (!this->dictionary) {
+        throw std::invalid_argument("CipherEngine needs a dictionary");
+    }
+    for (int i = 0; i < 26; ++i) {
+        logFrequency[i] = std::log(ENGLISH_FREQUENCIES[i]);
+        randomMean += logFrequency[i] / 26.0;
+        englishMean += ENGLISH_FREQUENCIES[i] * logFrequency[i];
+    }
+}
+
+// Request metrics are labelled by cipher and mode; names outside the known
+// set share one label so arbitrary input cannot create unbounded series.
+CipherJobResult CipherEngine::run(const CipherJob& job) const {
+    FSCT_TRACE_SCOPE("CipherEngine::run");
+    if (!MetricsRegistry::enabled()) return execute(job);
+
+    static const char* const CIPHERS[] = {"caesar", "vigenere", "affine", "transposition", "playfair"};
+    static const char* const MODES[] = {"encrypt", "decrypt", "crack"};
+    auto known = [](const std::string& name, const auto& names) {
+        return std::find(std::begin(names), std::end(names), name) != std::end(names) ? name : std::string("other");
+    };
+    MetricLabels labels = {{"cipher", known(job.cipher, CIPHERS)}, {"mode", known(job.mode, MODES)}};
+
+    MetricsRegistry& registry = MetricsRegistry::global();
+    CipherJobResult result;
+    {
+        ScopedLatency timer(&registry.histogram("fsct_request_duration_seconds",
+                                                "Time to run one cipher job", labels));
+        result = execute(job);
+    }
+    labels["status"] = result.ok ? "ok" : "error";
+    registry.counter("fsct_requests_total", "Cipher jobs run", labels).add();
+    return result;
+}
+
+CipherJobResult CipherEngine::execute(const CipherJob& job) const {
+    try {
+        if (job.mode == "encrypt") return transform(job, true);
+        if (job.mode == "decrypt") return transform(job, false);
+        if (job.mode == "crack") {
+            if (job.cipher == "caesar") return crackCaesar(job.text);
+            if (job.cipher == "affine") return crackAffine(job.text);
+            if (job.cipher == "vigenere") return crackVigenere(job.text);
+            throw std::invalid_argument("crack is not supported for cipher: " + job.cipher);
+        }
+        throw std::invalid_argument("unknown mode: " + job.mode);
+    } catch (const std::exception& e) {
+        CipherJobResult result;
+        result.error = e.what();
+        return result;
+    }
+}
+
+CipherJobResult CipherEngine::transform(const CipherJob& job, bool encrypt) const {
+    CipherJobResult result;
+    Dictionary* dict = dictionary.get();
+
+    if (job.cipher == "caesar") {
+        int shift = ((parseInteger(job.key) % 26) + 26) % 26;
+        Caesar caesar(job.text, dict);
+        result.output = encrypt ? caesar.encrypt(shift) : caesar.decrypt(shift);
+        result.key = std::to_string(shift);
+    } else if (job.cipher == "vigenere") {
+        result.key = letterKey(job.key);
+        Vigenere vigenere(job.text, dict, result.key);
+        result.output = encrypt ? vigenere.encrypt() : vigenere.decrypt();
+    } else if (job.cipher == "affine") {
+        int a, b;
+        parseAffineKey(job.key, a, b);
+        Affine affine(job.text, dict, a, b);
+        result.output = encrypt ? affine.encrypt() : affine.decrypt();
+        result.key = std::to_string(a) + "," + std::to_string(b);
+    } else if (job.cipher == "transposition") {
+        int columns = parseInteger(job.key);
+        // More columns than letters only adds padding, and a huge count would
+        // allocate that many bytes for a single grid row
+        if (columns > 0 && static_cast<size_t>(columns) > std::max<size_t>(1, job.text.length())) {
+            throw std::invalid_argument("transposition key must not exceed the text length of " +
+                                        std::to_string(job.text.length()));
+        }
+        Transposition transposition(job.text, dict);
+        result.output = encrypt ? transposition.encrypt(columns) : transposition.decrypt(columns);
+        result.key = std::to_string(columns);
+    } else if (job.cipher == "playfair") {
+        result.key = letterKey(job.key);
+        Playfair playfair(job.text, dict, result.key);
+        result.output = encrypt ? playfair.encrypt() : playfair.decrypt();
+    } else {
+        throw std::invalid_argument("unknown cipher: " + job.cipher);
+    }
+
+    result.ok = true;
+    return result;
+}
+
+CipherJobResult CipherEngine::crackCaesar(const std::string& text) const {
+    std::vector<uint8_t> letters = lettersOf(text);
+    LetterCounts counts{};
+    for (uint8_t letter : letters) counts[letter]++;
+
+    std::vector<Candidate> candidates;
+    for (int shift = 0; shift < 26; ++shift) {
+        double likelihood = 0.0;
+        for (int c = 0; c < 26; ++c) {
+            likelihood += counts[c] * logFrequency[(c - shift + 26) % 26];
+        }
+        candidates.push_back({std::to_string(shift), likelihood});
+    }
+    return pickBest("caesar", text, candidates, REFINE_COUNT);
+}
+
+CipherJobResult CipherEngine::crackAffine(const std::string& text) const {
+    std::vector<uint8_t> letters = lettersOf(text);
+    LetterCounts counts{};
+    for (uint8_t letter : letters) counts[letter]++;
+
+    std::vector<Candidate> candidates;
+    for (int a : AFFINE_MULTIPLIERS) {
+        int inverse = modInverse26(a);
+        for (int b = 0; b < 26; ++b) {
+            double likelihood = 0.0;
+            for (int c = 0; c < 26; ++c) {
+                likelihood += counts[c] * logFrequency[(inverse * (c - b + 26)) % 26];
+            }
+            candidates.push_back({std::to_string(a) + "," + std::to_string(b), likelihood});
+        }
+    }
+    return pickBest("affine", text, candidates, REFINE_COUNT);
+}
+
+// Each likely period from PatternFinder (plus period 1) gets its most
+// English-looking shift per column. Longer periods always fit letter
+// frequencies at least as well, so periods far behind the best guess are
+// dropped, the rest all go to the dictionary pass, and ties favour the
+// shorter key.
+CipherJobResult CipherEngine::crackVigenere(const std::string& text) const {
+    std::vector<uint8_t> letters = lettersOf(text);
+    std::vector<size_t> periods = {1};
+    auto ranked = PatternFinder(text).rankKeyLengths(MAX_VIGENERE_KEY, 3, VIGENERE_PERIODS);
+    for (const auto& candidate : ranked) {
+        if (candidate.confidence >= PERIOD_CONFIDENCE_RATIO * ranked.front().confidence) {
+            periods.push_back(candidate.length);
+        }
+    }
+
+    std::vector<Candidate> candidates;
+    for (size_t period : periods) {
+        std::vector<LetterCounts> columns(period, LetterCounts{});
+        for (size_t i = 0; i < letters.size(); ++i) {
+            columns[i % period][letters[i]]++;
+        }
+
+        std::string key;
+        double likelihood = 0.0;
+        for (const auto& counts : columns) {
+            int bestShift = 0;
+            double bestLikelihood = -INFINITY;
+            for (int shift = 0; shift < 26; ++shift) {
+                double columnLikelihood = 0.0;
+                for (int c = 0; c < 26; ++c) {
+                    columnLikelihood += counts[c] * logFrequency[(c - shift + 26) % 26];
+                }
+                if (columnLikelihood > bestLikelihood) {
+                    bestLikelihood = columnLikelihood;
+                    bestShift = shift;
+                }
+            }
+            key += static_cast<char>('a' + bestShift);
+            likelihood += bestLikelihood;
+        }
+
+        key = primitiveKey(key);
+        bool seen = std::any_of(candidates.begin(), candidates.end(),
+                                [&key](const Candidate& c) { return c.key == key; });
+        if (!seen) candidates.push_back({key, likelihood});
+    }
+
+    return pickBest("vigenere", text, candidates, candidates.size());
+}
+
+CipherJobResult CipherEngine::pickBest(const std::string& cipher, const std::string& text,
+                                       std::vector<Candidate>& candidates, size_t refine) const {
+    if (lettersOf(text).empty()) {
+        throw std::invalid_argument("no letters to crack");
+    }
+    refine = std::min(refine, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + refine, candidates.end(),
+                      [](const Candidate& a, const Candidate& b) { return a.likelihood > b.likelihood; });
+
+    CipherJobResult best;
+    for (size_t i = 0; i < refine; ++i) {
+        std::string plaintext = decryptWith(cipher, text, candidates[i].key);
+        double score = scorePlaintext(plaintext);
+        bool shorterTie = score == best.score && candidates[i].key.length() < best.key.length();
+        if (!best.ok || score > best.score || shorterTie) {
+            best.ok = true;
+            best.key = candidates[i].key;
+            best.output = plaintext;
+            best.score = score;
+        }
+    }
+    return best;
+}
+
+std::string CipherEngine::decryptWith(const std::string& cipher, const std::string& text,
+                                      const std::string& key) const {
+    CipherJob job{cipher, "decrypt", key, text};
+    return transform(job, false).output;
+}
+
+double CipherEngine::letterScore(const std::string& text) const {
+    double sum = 0.0;
+    size_t length = 0;
+    for (char c : text) {
+        if (std::isalpha(static_cast<unsigned char>(c))) {
+            sum += logFrequency[std::tolower(static_cast<unsigned char>(c)) - 'a'];
+            length++;
+        }
+    }
+    if (length == 0) return 0.0;
+    double scaled = (sum / length - randomMean) / (englishMean - randomMean);
+    return std::max(0.0, std::min(1.0, scaled));
+}
+
+double CipherEngine::scorePlaintext(const std::string& text) const {
+    if (MetricsRegistry::enabled()) {
+        static Counter& calls = MetricsRegistry::global().counter(
+            "fsct_scoring_calls_total", "Candidate plaintexts scored against the dictionary");
+        calls.add();
+    }
+    size_t words = 0;
+    bool inWord = false;
+    for (char c : text) {
+        bool space = std::isspace(static_cast<unsigned char>(c));
+        if (!space && !inWord) words++;
+        inWord = !space;
+    }
+    double coverage = words ? static_cast<double>(dictionary->countMatches(text)) / words : 0.0;
+    return 0.5 * letterScore(text) + 0.5 * coverage;
+}
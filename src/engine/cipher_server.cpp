@@ -0,0 +1,197 @@
+#include "../../include/engine/cipher_server.hpp"
+#include "../../include/telemetry/metrics.hpp"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+// How often the accept loop looks at the stop flag
+constexpr int ACCEPT_POLL_MS = 200;
+constexpr int LISTEN_BACKLOG = 128;
+// Connections past this many are sent an error and closed, so each costs no reader thread
+constexpr size_t MAX_CONNECTIONS = 256;
+// A client that stops reading its responses holds a worker for at most this long
+constexpr int WRITE_TIMEOUT_SECONDS = 10;
+// Requests in this mode return the Prometheus metrics dump instead of running a job
+const char* const METRICS_MODE = "metrics";
+}
+
+CipherServer::Connection::~Connection() {
+    ::close(fd);
+}
+
+CipherServer::CipherServer(const CipherEngine& engine, const std::string& socketPath, size_t workers,
+                           size_t queueCapacity)
+    : engine(engine), socketPath(socketPath), workerCount(workers), queue(queueCapacity), stopping(false) {
+    if (workerCount == 0) {
+        throw std::invalid_argument("CipherServer needs at least one worker");
+    }
+    if (socketPath.length() >= sizeof(sockaddr_un::sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + socketPath);
+    }
+}
+
+CipherServer::~CipherServer() {
+    stop();
+}
+
+void CipherServer::stop() {
+    stopping.store(true);
+}
+
+void CipherServer::run() {
+    // Replace a stale socket left by an earlier run, but nothing else
+    struct stat existing;
+    if (::stat(socketPath.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        ::unlink(socketPath.c_str());
+    }
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error(std::string("Failed to create socket: ") + std::strerror(errno));
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listener, LISTEN_BACKLOG) < 0) {
+        std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Failed to listen on " + socketPath + ": " + reason);
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&CipherServer::workLoop, this);
+    }
+
+    while (!stopping.load()) {
+        pollfd ready{listener, POLLIN, 0};
+        int events = ::poll(&ready, 1, ACCEPT_POLL_MS);
+        reapReaders(false);
+        if (events <= 0) continue;
+
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        timeval timeout{WRITE_TIMEOUT_SECONDS, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        auto connection = std::make_shared<Connection>(fd);
+        if (readers.size() >= MAX_CONNECTIONS) {
+            FrameResponse busy;
+            busy.result.error = "Server is at its limit of " + std::to_string(MAX_CONNECTIONS) + " connections";
+            respond(*connection, busy);
+            continue;
+        }
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread([this, connection, done]() {
+            readLoop(connection);
+            done->store(true);
+        });
+        readers.push_back({std::move(thread), connection, done});
+    }
+
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+
+    // Unblock readers waiting on their clients, let queued work finish, then stop the workers
+    for (auto& reader : readers) {
+        ::shutdown(reader.connection->fd, SHUT_RD);
+    }
+    reapReaders(true);
+    queue.close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void CipherServer::reapReaders(bool all) {
+    for (size_t i = 0; i < readers.size();) {
+        if (all || readers[i].done->load()) {
+            readers[i].thread.join();
+            readers[i] = std::move(readers.back());
+            readers.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+// A malformed body is answered with an error; a broken frame ends the connection
+void CipherServer::readLoop(std::shared_ptr<Connection> connection) {
+    std::string body;
+    while (true) {
+        try {
+            if (!readFrame(connection->fd, body)) return;
+        } catch (const std::runtime_error&) {
+            return;
+        }
+
+        Work work;
+        work.connection = connection;
+        try {
+            work.request = decodeRequest(body);
+        } catch (const std::invalid_argument& e) {
+            FrameResponse response;
+            response.result.error = e.what();
+            respond(*connection, response);
+            continue;
+        }
+        if (!queue.push(std::move(work))) return;
+        if (MetricsRegistry::enabled()) {
+            static Gauge& depth = MetricsRegistry::global().gauge(
+                "fsct_server_queue_depth_max", "Most requests ever waiting in the server queue at once");
+            depth.observeMax(static_cast<int64_t>(queue.size()));
+        }
+    }
+}
+
+void CipherServer::workLoop() {
+    Work work;
+    while (queue.pop(work)) {
+        FrameResponse response;
+        response.id = work.request.id;
+        if (work.request.job.mode == METRICS_MODE) {
+            if (MetricsRegistry::enabled()) {
+                response.result.ok = true;
+                response.result.output = MetricsRegistry::global().prometheusText();
+            } else {
+                response.result.error = "metrics are disabled on this server";
+            }
+        } else {
+            response.result = engine.run(work.request.job);
+        }
+        respond(*work.connection, response);
+        work.connection.reset();
+    }
+}
+
+// Clients that have disconnected simply miss their responses. A result too
+// large for one frame is answered with an error rather than dropped.
+void CipherServer::respond(Connection& connection, const FrameResponse& response) {
+    try {
+        std::string body;
+        try {
+            body = encodeResponse(response);
+        } catch (const std::length_error& e) {
+            FrameResponse tooLarge;
+            tooLarge.id = response.id;
+            tooLarge.result.error = std::string("Response too large: ") + e.what();
+            body = encodeResponse(tooLarge);
+        }
+        std::lock_guard<std::mutex> lock(connection.writeMutex);
+        try {
+            writeFrame(connection.fd, body);
+        } catch (const std::runtime_error&) {
+            // A failed or timed-out write may have sent part of a frame, so the
+            // connection is dropped: its reader stops and later writes fail at once
+            ::shutdown(connection.fd, SHUT_RDWR);
+        }
+    } catch (const std::exception&) {
+    }
+}
@@ -0,0 +1,161 @@
+#include "../../include/engine/frame_protocol.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+void putLE(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void putString(std::string& out, const std::string& value) {
+    putLE(out, value.length(), 4);
+    out += value;
+}
+
+// The whole body, not any one field, has to fit in a frame readFrame accepts
+const std::string& checkedBody(const std::string& body) {
+    if (body.length() > MAX_FRAME_BYTES) {
+        throw std::length_error("Frame of " + std::to_string(body.length()) + " bytes exceeds the limit");
+    }
+    return body;
+}
+
+// Sequential reader over a frame body
+class BodyReader {
+public:
+    explicit BodyReader(const std::string& body) : body(body), pos(0) {}
+
+    uint64_t integer(size_t bytes) {
+        need(bytes);
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(body[pos + i])) << (8 * i);
+        }
+        pos += bytes;
+        return value;
+    }
+
+    std::string string() {
+        size_t length = integer(4);
+        need(length);
+        std::string value = body.substr(pos, length);
+        pos += length;
+        return value;
+    }
+
+    void finish() const {
+        if (pos != body.length()) throw std::invalid_argument("Trailing bytes in frame");
+    }
+
+private:
+    const std::string& body;
+    size_t pos;
+
+    void need(size_t bytes) const {
+        if (body.length() - pos < bytes) throw std::invalid_argument("Truncated frame");
+    }
+};
+
+// False if the stream ended before the first byte
+bool readFully(int fd, char* data, size_t length) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t got = ::recv(fd, data + done, length - done, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) throw std::runtime_error(std::string("Socket read failed: ") + std::strerror(errno));
+        if (got == 0) {
+            if (done == 0) return false;
+            throw std::runtime_error("Connection closed mid-frame");
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+}
+
+std::string encodeRequest(const FrameRequest& request) {
+    std::string body;
+    putLE(body, request.id, 8);
+    putString(body, request.job.cipher);
+    putString(body, request.job.mode);
+    putString(body, request.job.key);
+    putString(body, request.job.text);
+    return checkedBody(body);
+}
+
+std::string encodeResponse(const FrameResponse& response) {
+    std::string body;
+    putLE(body, response.id, 8);
+    body.push_back(response.result.ok ? 0 : 1);
+    uint64_t scoreBits;
+    std::memcpy(&scoreBits, &response.result.score, sizeof(scoreBits));
+    putLE(body, scoreBits, 8);
+    putString(body, response.result.key);
+    putString(body, response.result.ok ? response.result.output : response.result.error);
+    return checkedBody(body);
+}
+
+FrameRequest decodeRequest(const std::string& body) {
+    BodyReader reader(body);
+    FrameRequest request;
+    request.id = reader.integer(8);
+    request.job.cipher = reader.string();
+    request.job.mode = reader.string();
+    request.job.key = reader.string();
+    request.job.text = reader.string();
+    reader.finish();
+    return request;
+}
+
+FrameResponse decodeResponse(const std::string& body) {
+    BodyReader reader(body);
+    FrameResponse response;
+    response.id = reader.integer(8);
+    uint64_t status = reader.integer(1);
+    if (status > 1) throw std::invalid_argument("Unknown response status");
+    response.result.ok = status == 0;
+    uint64_t scoreBits = reader.integer(8);
+    std::memcpy(&response.result.score, &scoreBits, sizeof(scoreBits));
+    response.result.key = reader.string();
+    (response.result.ok ? response.result.output : response.result.error) = reader.string();
+    reader.finish();
+    return response;
+}
+
+bool readFrame(int fd, std::string& body) {
+    char header[4];
+    if (!readFully(fd, header, sizeof(header))) return false;
+    size_t length = 0;
+    for (size_t i = 0; i < sizeof(header); ++i) {
+        length |= static_cast<size_t>(static_cast<unsigned char>(header[i])) << (8 * i);
+    }
+    if (length > MAX_FRAME_BYTES) {
+        throw std::runtime_error("Frame of " + std::to_string(length) + " bytes exceeds the limit");
+    }
+    body.resize(length);
+    if (length > 0 && !readFully(fd, &body[0], length)) {
+        throw std::runtime_error("Connection closed mid-frame");
+    }
+    return true;
+}
+
+void writeFrame(int fd, const std::string& body) {
+    std::string frame;
+    frame.reserve(body.length() + 4);
+    putLE(frame, body.length(), 4);
+    frame += body;
+
+    size_t done = 0;
+    while (done < frame.length()) {
+        // MSG_NOSIGNAL: a vanished peer is an error here, not a SIGPIPE
+        ssize_t sent = ::send(fd, frame.data() + done, frame.length() - done, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0) throw std::runtime_error(std::string("Socket write failed: ") + std::strerror(errno));
+        done += static_cast<size_t>(sent);
+    }
+}
@@ -0,0 +1,264 @@
+#include "../../include/engine/jsonl.hpp"
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+class RecordParser {
+public:
+    explicit RecordParser(const std::string& line) : text(line), pos(0) {}
+
+    JsonRecord parse() {
+        JsonRecord record;
+        skipSpace();
+        expect('{');
+        skipSpace();
+        if (peek() == '}') {
+            ++pos;
+        } else {
+            while (true) {
+                skipSpace();
+                std::string key = parseString();
+                skipSpace();
+                expect(':');
+                skipSpace();
+                bool isNull = false;
+                JsonValue value = parseValue(isNull);
+                if (!isNull) record[key] = value;
+                skipSpace();
+                if (peek() == ',') {
+                    ++pos;
+                    continue;
+                }
+                expect('}');
+                break;
+            }
+        }
+        skipSpace();
+        if (pos != text.length()) fail("trailing characters after record");
+        return record;
+    }
+
+private:
+    const std::string& text;
+    size_t pos;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument("JSON error at column " + std::to_string(pos + 1) + ": " + message);
+    }
+
+    char peek() const {
+        return pos < text.length() ? text[pos] : '\0';
+    }
+
+    void expect(char c) {
+        if (peek() != c) fail(std::string("expected '") + c + "'");
+        ++pos;
+    }
+
+    void skipSpace() {
+        while (pos < text.length() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+            ++pos;
+        }
+    }
+
+    JsonValue parseValue(bool& isNull) {
+        char c = peek();
+        if (c == '"') return {parseString(), false};
+        if (c == '{' || c == '[') fail("nested values are not supported");
+
+        size_t start = pos;
+        while (pos < text.length() && text[pos] != ',' && text[pos] != '}' &&
+               text[pos] != ' ' && text[pos] != '\t' && text[pos] != '\r') {
+            ++pos;
+        }
+        std::string literal = text.substr(start, pos - start);
+        if (literal == "null") {
+            isNull = true;
+            return {literal, true};
+        }
+        if (literal == "true" || literal == "false") return {literal, true};
+
+        char* end = nullptr;
+        std::strtod(literal.c_str(), &end);
+        if (literal.empty() || end != literal.c_str() + literal.length()) {
+            pos = start;
+            fail("invalid value");
+        }
+        return {literal, true};
+    }
+
+    unsigned parseHex4() {
+        if (pos + 4 > text.length()) fail("truncated \\u escape");
+        unsigned value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else fail("invalid \\u escape");
+        }
+        return value;
+    }
+
+    static void appendUtf8(std::string& out, unsigned codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (true) {
+            if (pos >= text.length()) fail("unterminated string");
+            char c = text[pos++];
+            if (c == '"') break;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.length()) fail("unterminated escape");
+            char e = text[pos++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned codePoint = parseHex4();
+                    // A high surrogate must be followed by its low half
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                        if (text.compare(pos, 2, "\\u") != 0) fail("unpaired surrogate");
+                        pos += 2;
+                        unsigned low = parseHex4();
+                        if (low < 0xDC00 || low >= 0xE000) fail("unpaired surrogate");
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default:
+                    fail("invalid escape");
+            }
+        }
+        return out;
+    }
+};
+}
+
+JsonRecord parseJsonRecord(const std::string& line) {
+    return RecordParser(line).parse();
+}
+
+std::string jsonQuote(const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(text.length() + 2);
+    out += '"';
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (u < 0x20) {
+                    out += "\\u00";
+                    out += hex[u >> 4];
+                    out += hex[u & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+JsonRecordBuilder& JsonRecordBuilder::add(const std::string& key, const std::string& value) {
+    addRaw(key, jsonQuote(value));
+    return *this;
+}
+
+JsonRecordBuilder& JsonRecordBuilder::add(const std::string& key, const char* value) {
+    return add(key, std::string(value));
+}
+
+JsonRecordBuilder& JsonRecordBuilder::add(const std::string& key, double value) {
+    if (!std::isfinite(value)) {
+        addRaw(key, "null");
+        return *this;
+    }
+    char literal[32];
+    std::snprintf(literal, sizeof(literal), "%.6g", value);
+    addRaw(key, literal);
+    return *this;
+}
+
+JsonRecordBuilder& JsonRecordBuilder::add(const std::string& key, size_t value) {
+    addRaw(key, std::to_string(value));
+    return *this;
+}
+
+JsonRecordBuilder& JsonRecordBuilder::add(const std::string& key, bool value) {
+    addRaw(key, value ? "true" : "false");
+    return *this;
+}
+
+JsonRecordBuilder& JsonRecordBuilder::add(const std::string& key, const JsonValue& value) {
+    addRaw(key, value.literal ? value.text : jsonQuote(value.text));
+    return *this;
+}
+
+void JsonRecordBuilder::addRaw(const std::string& key, const std::string& literal) {
+    body += body.empty() ? "" : ",";
+    body += jsonQuote(key);
+    body += ':';
+    body += literal;
+}
+
+std::string JsonRecordBuilder::str() const {
+    return "{" + body + "}";
+}
+
+JsonlWriter::JsonlWriter(std::ostream& out, size_t bufferBytes) : out(out), capacity(bufferBytes) {
+    buffer.reserve(capacity);
+}
+
+JsonlWriter::~JsonlWriter() {
+    flush();
+}
+
+void JsonlWriter::write(const std::string& record) {
+    buffer += record;
+    buffer += '\n';
+    if (buffer.length() >= capacity) flush();
+}
+
+void JsonlWriter::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), buffer.length());
+        buffer.clear();
+    }
+    out.flush();
+}
@@ -0,0 +1,189 @@
+#include "../../include/engine/workload_generator.hpp"
+#include "../../include/engine/jsonl.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+const int AFFINE_MULTIPLIERS[] = {3, 5, 7, 9, 11, 15, 17, 19, 21, 23, 25};
+
+// Sentences run to between MIN_SENTENCE and MIN_SENTENCE + SENTENCE_SPREAD - 1 words
+constexpr size_t MIN_SENTENCE = 6;
+constexpr size_t SENTENCE_SPREAD = 10;
+
+// Lower-case letters of token, dropping everything else
+std::string cleanToken(const std::string& token) {
+    std::string cleaned;
+    for (char c : token) {
+        if (std::isalpha(static_cast<unsigned char>(c))) {
+            cleaned += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return cleaned;
+}
+
+bool crackable(const std::string& cipher) {
+    return cipher == "caesar" || cipher == "affine" || cipher == "vigenere";
+}
+}
+
+MarkovTextModel MarkovTextModel::fromCorpus(std::istream& in) {
+    MarkovTextModel model;
+    std::unordered_map<std::string, uint32_t> index;
+    std::string token;
+    bool hasPrevious = false;
+    uint32_t previous = 0;
+
+    while (in >> token) {
+        std::string word = cleanToken(token);
+        if (word.empty()) continue;
+        auto inserted = index.emplace(word, static_cast<uint32_t>(model.words.size()));
+        if (inserted.second) {
+            model.words.push_back(word);
+            model.successors.emplace_back();
+        }
+        uint32_t current = inserted.first->second;
+        if (hasPrevious) model.successors[previous].push_back(current);
+        model.starts.push_back(current);
+        previous = current;
+        hasPrevious = true;
+    }
+
+    if (model.words.empty()) {
+        throw std::invalid_argument("Corpus has no words");
+    }
+    return model;
+}
+
+MarkovTextModel MarkovTextModel::fromWords(const std::vector<std::string>& words) {
+    MarkovTextModel model;
+    for (const auto& entry : words) {
+        std::string word = cleanToken(entry);
+        if (word.empty()) continue;
+        uint32_t current = static_cast<uint32_t>(model.words.size());
+        model.words.push_back(word);
+        model.successors.emplace_back();
+        // Words of up to three letters are drawn six times as often as long ones
+        size_t weight = word.size() >= 8 ? 1 : std::min<size_t>(6, 9 - word.size());
+        model.starts.insert(model.starts.end(), weight, current);
+    }
+
+    if (model.words.empty()) {
+        throw std::invalid_argument("Word list is empty");
+    }
+    return model;
+}
+
+size_t MarkovTextModel::vocabularySize() const {
+    return words.size();
+}
+
+uint32_t MarkovTextModel::nextWord(uint32_t current, bool restart, std::mt19937_64& rng) const {
+    if (restart || successors[current].empty()) {
+        return starts[rng() % starts.size()];
+    }
+    const std::vector<uint32_t>& next = successors[current];
+    return next[rng() % next.size()];
+}
+
+std::string MarkovTextModel::generate(size_t length, std::mt19937_64& rng) const {
+    std::string text;
+    size_t sentenceLeft = 0;
+    uint32_t word = 0;
+
+    while (text.size() < length) {
+        bool sentenceStart = sentenceLeft == 0;
+        if (sentenceStart) sentenceLeft = MIN_SENTENCE + rng() % SENTENCE_SPREAD;
+        word = nextWord(word, text.empty(), rng);
+
+        std::string token = words[word];
+        if (sentenceStart) token[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(token[0])));
+        if (--sentenceLeft == 0) token += '.';
+
+        if (!text.empty()) {
+            if (text.size() + 1 + token.size() > length) break;
+            text += ' ';
+        }
+        text += token;
+    }
+    return text;
+}
+
+WorkloadGenerator::WorkloadGenerator(const CipherEngine& engine, const MarkovTextModel& model,
+                                     const WorkloadOptions& options)
+    : engine(engine), model(model), options(options) {
+    static const char* const CIPHERS[] = {"caesar", "vigenere", "affine", "transposition", "playfair"};
+    if (std::find(std::begin(CIPHERS), std::end(CIPHERS), options.cipher) == std::end(CIPHERS)) {
+        throw std::invalid_argument("Unknown cipher: " + options.cipher);
+    }
+    if (options.minKeyLength == 0 || options.minKeyLength > options.maxKeyLength) {
+        throw std::invalid_argument("Key lengths must satisfy 1 <= min <= max");
+    }
+    if (options.count == 0) {
+        throw std::invalid_argument("Message count must be at least 1");
+    }
+}
+
+std::string WorkloadGenerator::randomKey(std::mt19937_64& rng, size_t textLength) const {
+    if (options.cipher == "caesar") {
+        return std::to_string(1 + rng() % 25);
+    }
+    if (options.cipher == "affine") {
+        int a = AFFINE_MULTIPLIERS[rng() % (sizeof(AFFINE_MULTIPLIERS) / sizeof(AFFINE_MULTIPLIERS[0]))];
+        return std::to_string(a) + "," + std::to_string(rng() % 26);
+    }
+
+    size_t length = options.minKeyLength + rng() % (options.maxKeyLength - options.minKeyLength + 1);
+    if (options.cipher == "transposition") {
+        return std::to_string(std::min(length, textLength));
+    }
+    std::string key(length, 'a');
+    for (auto& c : key) {
+        c = static_cast<char>('a' + rng() % 26);
+    }
+    return key;
+}
+
+// Each message draws from its own generator, seeded from the run seed and
+// its index, so a record depends only on the seed, its index and its length.
+// The length comes from totalBytes / count, so changing --count or --size
+// changes every record, not just how many there are.
+size_t WorkloadGenerator::run(std::ostream& out) const {
+    JsonlWriter writer(out);
+    const size_t messageBytes = options.totalBytes / options.count;
+    const size_t longerMessages = options.totalBytes % options.count;
+    const std::string mode = crackable(options.cipher) ? "crack" : "decrypt";
+
+    for (size_t i = 0; i < options.count; ++i) {
+        std::seed_seq seeds{static_cast<uint32_t>(options.seed), static_cast<uint32_t>(options.seed >> 32),
+                            static_cast<uint32_t>(i), static_cast<uint32_t>(static_cast<uint64_t>(i) >> 32)};
+        std::mt19937_64 rng(seeds);
+
+        std::string plaintext = model.generate(std::max<size_t>(1, messageBytes + (i < longerMessages)), rng);
+        CipherJobResult encrypted = engine.run({options.cipher, "encrypt", randomKey(rng, plaintext.length()), plaintext});
+        if (!encrypted.ok) {
+            throw std::runtime_error("Encrypting message " + std::to_string(i + 1) + " failed: " + encrypted.error);
+        }
+
+        // Playfair decrypts to lower-case letters with j as i and x padding, and
+        // transposition keeps its space padding, so the ground truth for
+        // decrypt records is what a correct decrypt returns
+        std::string expected = plaintext;
+        if (mode == "decrypt") {
+            CipherJobResult decrypted = engine.run({options.cipher, "decrypt", encrypted.key, encrypted.output});
+            if (!decrypted.ok) {
+                throw std::runtime_error("Decrypting message " + std::to_string(i + 1) + " failed: " + decrypted.error);
+            }
+            expected = decrypted.output;
+        }
+
+        JsonRecordBuilder record;
+        record.add("id", std::to_string(i + 1)).add("cipher", options.cipher).add("mode", mode);
+        if (mode == "decrypt") record.add("key", encrypted.key);
+        record.add("text", encrypted.output).add("expected_key", encrypted.key).add("plaintext", expected);
+        writer.write(record.str());
+    }
+    writer.flush();
+    return options.count;
+}
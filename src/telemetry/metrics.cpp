@@ -0,0 +1,237 @@
+#include "../../include/telemetry/metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+
+namespace {
+// Cumulative bucket boundaries of the exported histograms, in seconds
+const double EXPORT_BOUNDS[] = {
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4,
+    1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+const double EXPORT_QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+std::string renderLabels(const MetricLabels& labels) {
+    std::string text;
+    for (const auto& label : labels) {
+        if (!text.empty()) text += ',';
+        text += label.first + "=\"";
+        for (char c : label.second) {
+            if (c == '\\' || c == '"') text += '\\';
+            if (c == '\n') {
+                text += "\\n";
+                continue;
+            }
+            text += c;
+        }
+        text += '"';
+    }
+    return text;
+}
+
+// name{labels,extra} with the braces left out when there are no labels
+std::string series(const std::string& name, const std::string& labels, const std::string& extra = "") {
+    std::string all = labels;
+    if (!extra.empty()) all += (all.empty() ? "" : ",") + extra;
+    return all.empty() ? name : name + "{" + all + "}";
+}
+
+std::string formatSeconds(double seconds) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", seconds);
+    return text;
+}
+}
+
+std::atomic<bool> MetricsRegistry::enabledFlag(false);
+
+void Gauge::observeMax(int64_t v) {
+    int64_t current = value.load(std::memory_order_relaxed);
+    while (current < v && !value.compare_exchange_weak(current, v, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : buckets(new std::atomic<uint64_t>[BUCKET_COUNT]), total(0), sum(0), max(0) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Values below 2^SUB_BUCKET_BITS index directly. Larger values keep their top
+// SUB_BUCKET_BITS bits: shift drops the rest and the mantissa, which always
+// has its top bit set, picks one of the half-range sub-buckets of that octave.
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    const uint64_t direct = 1ull << SUB_BUCKET_BITS;
+    if (value < direct) return static_cast<size_t>(value);
+    unsigned msb = 63 - __builtin_clzll(value);
+    unsigned shift = msb - (SUB_BUCKET_BITS - 1);
+    uint64_t mantissa = value >> shift;
+    const uint64_t half = direct >> 1;
+    return static_cast<size_t>(direct + (shift - 1) * half + (mantissa - half));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    const uint64_t direct = 1ull << SUB_BUCKET_BITS;
+    if (index < direct) return index;
+    const uint64_t half = direct >> 1;
+    uint64_t offset = index - direct;
+    unsigned shift = static_cast<unsigned>(offset / half) + 1;
+    uint64_t mantissa = half + offset % half + 1;
+    if (shift + SUB_BUCKET_BITS > 63 && mantissa == direct) return UINT64_MAX;
+    return (mantissa << shift) - 1;
+}
+
+void LatencyHistogram::recordNanoseconds(uint64_t nanoseconds) {
+    buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (current < nanoseconds && !max.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::sumNanoseconds() const {
+    return sum.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::maxNanoseconds() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::quantileNanoseconds(double q) const {
+    uint64_t recorded = count();
+    if (recorded == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * recorded));
+    rank = std::max<uint64_t>(1, std::min(rank, recorded));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketUpperBound(i), maxNanoseconds());
+    }
+    return maxNanoseconds();
+}
+
+uint64_t LatencyHistogram::countAtOrBelow(uint64_t bound) const {
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= bound; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+    }
+    return seen;
+}
+
+ScopedLatency::~ScopedLatency() {
+    if (histogram) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram->recordNanoseconds(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::setEnabled(bool enabled) {
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+// Lookups of existing series share the lock; only creation takes it exclusively
+template <typename T>
+T& MetricsRegistry::lookup(std::map<std::string, Family<T>>& families, const std::string& name,
+                           const std::string& help, const MetricLabels& labels) {
+    std::string key = renderLabels(labels);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto family = families.find(name);
+        if (family != families.end()) {
+            auto it = family->second.series.find(key);
+            if (it != family->second.series.end()) return *it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    Family<T>& family = families[name];
+    if (family.help.empty()) family.help = help;
+    std::unique_ptr<T>& slot = family.series[key];
+    if (!slot) slot.reset(new T());
+    return *slot;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    return lookup(counters, name, help, labels);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    return lookup(gauges, name, help, labels);
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const MetricLabels& labels) {
+    return lookup(histograms, name, help, labels);
+}
+
+// Histograms are exported as Prometheus histograms over fixed boundaries,
+// plus a gauge family of HDR quantiles computed from the fine buckets.
+void MetricsRegistry::writePrometheus(std::ostream& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    for (const auto& family : counters) {
+        out << "# HELP " << family.first << " " << family.second.help << "\n";
+        out << "# TYPE " << family.first << " counter\n";
+        for (const auto& entry : family.second.series) {
+            out << series(family.first, entry.first) << " " << entry.second->get() << "\n";
+        }
+    }
+
+    for (const auto& family : gauges) {
+        out << "# HELP " << family.first << " " << family.second.help << "\n";
+        out << "# TYPE " << family.first << " gauge\n";
+        for (const auto& entry : family.second.series) {
+            out << series(family.first, entry.first) << " " << entry.second->get() << "\n";
+        }
+    }
+
+    for (const auto& family : histograms) {
+        const std::string& name = family.first;
+        out << "# HELP " << name << " " << family.second.help << "\n";
+        out << "# TYPE " << name << " histogram\n";
+        for (const auto& entry : family.second.series) {
+            const LatencyHistogram& histogram = *entry.second;
+            for (double bound : EXPORT_BOUNDS) {
+                uint64_t below = histogram.countAtOrBelow(static_cast<uint64_t>(bound * 1e9));
+                out << series(name + "_bucket", entry.first, "le=\"" + formatSeconds(bound) + "\"") << " "
+                    << below << "\n";
+            }
+            out << series(name + "_bucket", entry.first, "le=\"+Inf\"") << " " << histogram.count() << "\n";
+            out << series(name + "_sum", entry.first) << " "
+                << formatSeconds(histogram.sumNanoseconds() / 1e9) << "\n";
+            out << series(name + "_count", entry.first) << " " << histogram.count() << "\n";
+        }
+
+        std::string quantiles = name + "_quantile";
+        out << "# HELP " << quantiles << " HDR quantiles of " << name << "\n";
+        out << "# TYPE " << quantiles << " gauge\n";
+        for (const auto& entry : family.second.series) {
+            for (double q : EXPORT_QUANTILES) {
+                char label[32];
+                std::snprintf(label, sizeof(label), "quantile=\"%g\"", q);
+                out << series(quantiles, entry.first, label) << " "
+                    << formatSeconds(entry.second->quantileNanoseconds(q) / 1e9) << "\n";
+            }
+        }
+    }
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    std::ostringstream out;
+    writePrometheus(out);
+    return out.str();
+}
@@ -0,0 +1,113 @@
+#include "../../include/telemetry/trace.hpp"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+// Spans past this many on one thread are counted but not kept
+constexpr size_t MAX_EVENTS_PER_THREAD = 1u << 20;
+
+struct TraceEvent {
+    const char* name;
+    int64_t beginNs;
+    int64_t durationNs;
+};
+
+struct ThreadBuffer {
+    uint32_t tid;
+    std::mutex mutex;  // only contended while the trace is being written
+    std::vector<TraceEvent> events;
+    uint64_t dropped = 0;
+};
+
+struct TraceState {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::atomic<int64_t> epochNs{0};
+    uint32_t nextTid = 1;
+};
+
+TraceState& state() {
+    static TraceState traceState;
+    return traceState;
+}
+
+int64_t nanosecondsOf(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+// The registry keeps a reference, so spans survive the thread that made them
+ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+        auto created = std::make_shared<ThreadBuffer>();
+        TraceState& traceState = state();
+        std::lock_guard<std::mutex> lock(traceState.mutex);
+        created->tid = traceState.nextTid++;
+        traceState.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+std::string escapeName(const char* name) {
+    std::string escaped;
+    for (const char* c = name; *c; ++c) {
+        if (*c == '"' || *c == '\\') escaped += '\\';
+        escaped += *c;
+    }
+    return escaped;
+}
+}
+
+std::atomic<bool> Tracer::enabledFlag(false);
+
+// The starting thread registers first, so it is tid 1 and named main
+void Tracer::start() {
+    localBuffer();
+    state().epochNs.store(nanosecondsOf(std::chrono::steady_clock::now()));
+    enabledFlag.store(true);
+}
+
+void Tracer::stop() {
+    enabledFlag.store(false);
+}
+
+void Tracer::record(const char* name, std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end) {
+    ThreadBuffer& buffer = localBuffer();
+    int64_t beginNs = nanosecondsOf(begin) - state().epochNs.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= MAX_EVENTS_PER_THREAD) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back({name, beginNs, nanosecondsOf(end) - nanosecondsOf(begin)});
+}
+
+// Complete ("X") events in microseconds, plus a name per thread and a count
+// of spans dropped for exceeding the per-thread limit
+void Tracer::writeChromeTrace(std::ostream& out) {
+    TraceState& traceState = state();
+    std::lock_guard<std::mutex> stateLock(traceState.mutex);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    char number[64];
+    for (const auto& buffer : traceState.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"" << (buffer->tid == 1 ? "main" : "thread " + std::to_string(buffer->tid))
+            << "\",\"dropped_spans\":" << buffer->dropped << "}}";
+        first = false;
+
+        for (const auto& event : buffer->events) {
+            std::snprintf(number, sizeof(number), "\"ts\":%.3f,\"dur\":%.3f", event.beginNs / 1000.0,
+                          event.durationNs / 1000.0);
+            out << ",\n{\"name\":\"" << escapeName(event.name) << "\",\"cat\":\"fsct\",\"ph\":\"X\","
+                << number << ",\"pid\":1,\"tid\":" << buffer->tid << "}";
+        }
+    }
+    out << "\n]}\n";
+}
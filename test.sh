@@ -22,3 +22,30 @@ echo "Testing vigenere cipher with default dictionary (encrypt)"
 echo "Testing vigenere cipher with default dictionary (decrypt)"
 ./bin/fsct vigenere -d "hello" "dssoh"  # Decrypt the text "world" with key "hello"
 
+
+# entropy profile of a file with a sliding window
+echo "Testing entropy profile over a file"
+./bin/fsct entropy --window=64 --step=32 README.md | head -n 5  # CSV profile of README.md
+
+# crib drag a vigenere ciphertext with a known plaintext fragment
+echo "Testing crib dragging over a vigenere ciphertext"
+./bin/fsct crib vigenere --crib="attackatdawn" --top=3 "hi yife efhnno mh qlaz prqsds gsi qbrxc mfetzqg"  # recovers key "lemon"
+
+# batch mode: crack a JSONL stream of ciphertexts in one process
+echo "Testing batch cracking of JSONL records"
+printf '%s\n' '{"id":"a","text":"Wkh txlfn eurzq ira mxpsv ryhu wkh odcb grj"}' '{"id":"b","cipher":"vigenere","mode":"decrypt","key":"lemon","text":"Lxfopv ef rnhr"}' | ./bin/fsct batch --cipher=caesar  # recovers shift 3, then decrypts with "lemon"
+
+# server mode: answer requests from a resident process over a Unix socket
+echo "Testing fsct serve and fsct client"
+./bin/fsct serve --socket=/tmp/fsct-test.sock & SERVER_PID=$!
+sleep 0.5
+./bin/fsct client --socket=/tmp/fsct-test.sock --cipher=caesar "Wkh txlfn eurzq ira mxpsv ryhu wkh odcb grj"  # recovers shift 3
+kill $SERVER_PID
+
+# tracing: record hot-path spans and export them for chrome://tracing or Perfetto
+echo "Testing Chrome trace export"
+./bin/fsct --trace=/tmp/fsct-trace.json caesar -e 3 "hello world" && head -c 200 /tmp/fsct-trace.json && echo
+
+# workload generator: reproducible encrypted messages with their keys, fed straight to batch mode
+echo "Testing fsct gen"
+./bin/fsct gen --cipher=caesar --size=2KB --count=4 --seed=7 | ./bin/fsct batch  # each "key" matches the generated "expected_key"